@@ -0,0 +1,119 @@
+/* Scratch arena : many concurrent hashes (e.g. one per socket) in bounded RAM
+
+   The algorithms work in the single shared buffer, so normally only one hash can be
+   in progress at a time; otherwise every context would need its own 64 byte block.
+   Here M streams share buffer : before a stream's Update() it is leased, which parks
+   the previous active stream's partial block (only count&0x3F bytes, not 64) in a
+   pool and brings back the leased stream's own.  The pool is kept compact, so it
+   needs only the sum of the streams' partial block lengths, on average about 32
+   bytes a stream, and at most 63.
+
+     ArenaInit(&arena,pool,sizeof(pool),slot,M);
+     ...
+     SHA256Lease(&ctx[s],&arena,s);       // 0 if the pool is full
+     SHA256Update(&ctx[s],data,len);
+     ...
+     SHA256Final(&ctx[s]);               // Result in buffer as usual
+     ArenaRelease(&arena,s);
+
+   The number of active slots K is the number of buffers : one, or with HASH_THREADS
+   one per thread, each thread then needing its own arena.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "arena.h"
+#include <string.h> // memcpy, memmove
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define ARENA_BUF_OFFSET  (4)  // Same for every algorithm's *_BUF_OFFSET
+
+static void Unpark(HASH_ARENA * arena,uint8_t stream,uint8_t restore);
+
+// --------------------------------------------------------------------------------
+void ArenaInit(HASH_ARENA * arena,char * pool,uint16_t size,ARENA_SLOT * slot,uint8_t streams)
+{ // All streams start with nothing parked (as after XXXInit()) and none active
+arena->pool=pool;
+arena->slot=slot;
+arena->size=size;
+arena->used=0;
+arena->streams=streams;
+arena->active=ARENA_NONE;
+memset(slot,0,streams*sizeof(ARENA_SLOT));
+}
+// --------------------------------------------------------------------------------
+uint8_t ArenaLease(HASH_ARENA * arena,uint8_t stream,uint32_t * count,uint8_t lsw)
+{ // Makes stream's partial block current in buffer, ready for its next Update() or
+  // Final().  Normally used through XXXLease().  Returns 0, with nothing changed, if
+  // the pool has no room to park the previously active stream.
+if (arena->active!=stream) {
+  if (arena->active!=ARENA_NONE) {
+    ARENA_SLOT * park=&arena->slot[arena->active];
+    uint8_t len=(((uint8_t)arena->count[arena->lsw])&0x3F);
+
+    if (arena->used+len<=arena->size) {  // Park, then bring back
+      memcpy(&arena->pool[arena->used],&buffer[ARENA_BUF_OFFSET],len);
+      park->offset=arena->used;
+      park->len=len;
+      arena->used+=len;
+      Unpark(arena,stream,1);
+    } else {                               // Only fits once stream's bytes are out
+      char swap[63];
+
+      if (arena->used+len>arena->size+arena->slot[stream].len) return 0;
+      memcpy(swap,&buffer[ARENA_BUF_OFFSET],len);
+      Unpark(arena,stream,1);
+      memcpy(&arena->pool[arena->used],swap,len);
+      park->offset=arena->used;
+      park->len=len;
+      arena->used+=len;
+    }
+  } else Unpark(arena,stream,1);
+  arena->active=stream;
+}
+arena->count=count;   // Context may have moved
+arena->lsw=lsw;
+return 1;
+}
+// --------------------------------------------------------------------------------
+void ArenaRelease(HASH_ARENA * arena,uint8_t stream)
+{ // Frees stream's space once it is finished (or abandoned).  It may be reused for a
+  // new hash straight away.
+Unpark(arena,stream,0);
+if (arena->active==stream) arena->active=ARENA_NONE;
+}
+// --------------------------------------------------------------------------------
+uint16_t ArenaBytes(HASH_ARENA * arena)
+{ // RAM in use for parking : pool, slots and the arena itself (buffer not included)
+return arena->size+arena->streams*sizeof(ARENA_SLOT)+sizeof(HASH_ARENA);
+}
+// --------------------------------------------------------------------------------
+static void Unpark(HASH_ARENA * arena,uint8_t stream,uint8_t restore)
+{ // Removes stream's parked bytes from the pool, optionally copying them back into
+  // buffer, and closes up the gap
+ARENA_SLOT * slot=&arena->slot[stream];
+uint16_t end=slot->offset+slot->len;
+
+if (slot->len==0) return;
+if (restore) memcpy(&buffer[ARENA_BUF_OFFSET],&arena->pool[slot->offset],slot->len);
+memmove(&arena->pool[slot->offset],&arena->pool[end],arena->used-end);
+for (uint8_t i=0;i<arena->streams;i++)
+  if (arena->slot[i].len && arena->slot[i].offset>=end) arena->slot[i].offset-=slot->len;
+arena->used-=slot->len;
+slot->len=0;
+}
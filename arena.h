@@ -0,0 +1,32 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+
+// Many concurrent hashes sharing buffer.  Each stream's partial block is either in
+// buffer (the active stream) or parked, at its exact length, in a compacted pool.
+
+#define ARENA_NONE  (0xFF)
+
+typedef struct {
+  uint16_t offset;       // Of the parked partial block in the pool
+  uint8_t  len;          // Parked bytes, 0..63
+} ARENA_SLOT;
+
+typedef struct {
+  char       * pool;     // size bytes of caller storage for parked partial blocks
+  ARENA_SLOT * slot;     // One per stream (caller storage)
+  uint32_t   * count;    // Active stream's count, to find its partial block length
+  uint16_t     size;
+  uint16_t     used;
+  uint8_t      streams;
+  uint8_t      active;   // Stream whose partial block is in buffer, or ARENA_NONE
+  uint8_t      lsw;
+} HASH_ARENA;
+
+void     ArenaInit(HASH_ARENA *,char * pool,uint16_t size,ARENA_SLOT * slot,uint8_t streams);
+uint8_t  ArenaLease(HASH_ARENA *,uint8_t stream,uint32_t * count,uint8_t lsw);
+void     ArenaRelease(HASH_ARENA *,uint8_t stream);
+uint16_t ArenaBytes(HASH_ARENA *);
+
+#endif
@@ -0,0 +1,189 @@
+/* Batch hashing of many independent messages
+
+   For millions of small records (log lines, keys ...) the caller fills an array of
+   jobs, each a message and an algorithm, and gets back one digest per job in a
+   single contiguous array, job i's digest at output[i*HASH_BATCH_STRIDE].  Jobs are
+   cut into chunks of about equal total length (plus HASH_JOB_OVERHEAD per job) and
+   the chunks are run on the work stealing pool, so threads stay balanced even when
+   lengths are very skewed.
+
+   Without HASH_THREADS (config.h) the same calls run serially.  With HASH_LANES,
+   each chunk's MD5 and RIPEMD160 jobs are hashed several at a time (lanes.c).
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "batch.h"
+#include "pool.h"
+#ifdef HASH_LANES
+#include "lanes.h"
+#endif
+#include <string.h> // memcpy
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define UPDATE_MAX  (0x8000)  // Update() takes uint16_t lengths
+
+typedef struct {
+  HASH_JOB * jobs;
+  char     * output;
+} BATCH;
+
+static void HashChunk(void * arg,uint32_t first,uint32_t last);
+
+#define KNOWN_LONG  (131)  // Chars in the second known answer message, 3 blocks and high bit set
+
+static const char * const Known[2*HASH_ID_BLAKE2S]={  // "abc", then KNOWN_LONG chars (37i+11)&0xFF
+  "900150983cd24fb0d6963f7d28e17f72",                                   // MD5
+  "98d2f0fa2c907bd6c7463c7763675743",
+  "a9993e364706816aba3e25717850c26c9cd0d89d",                           // SHA1
+  "deb45a91229e2e43b0370fd6a44c94366e4b0199",
+  "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",   // SHA256
+  "59af9661a687e63d741474741e090bc7af5eeca69f4312482a7b4b1a3d3607d9",
+  "8eb208f7e05d987a9b044a8e98c6b087f15a0bfc",                           // RIPEMD160
+  "6db1247fd52caae95ee76f95ed92bf1897196fff",
+  "508c5e8c327c14e2e1a72ba34eeb452f37458b209ed63a294d999b4c86675982",   // BLAKE2S
+  "2eaa1e672a2cf768cb521afd0f4734155353d264b9c558e3d643f1b96d23e074"};
+
+// --------------------------------------------------------------------------------
+uint8_t HashDigestBytes(uint8_t alg)
+{ // Size of alg's result, or 0 if alg is not known
+switch (alg) {
+  case HASH_ID_MD5:       return MD5_RESULT_BYTES;
+  case HASH_ID_SHA1:      return SHA1_RESULT_BYTES;
+  case HASH_ID_SHA256:    return SHA256_RESULT_BYTES;
+  case HASH_ID_RIPEMD160: return RIPEMD160_RESULT_BYTES;
+  case HASH_ID_BLAKE2S:   return BLAKE2S_RESULT_BYTES;
+}
+return 0;
+}
+// --------------------------------------------------------------------------------
+uint8_t HashAnyInit(HASH_ANY_CTX * context,uint8_t alg)
+{ // Returns the result size, or 0 if alg is not known
+context->alg=alg;
+switch (alg) {
+  case HASH_ID_MD5:       MD5Init(&context->md5);             break;
+  case HASH_ID_SHA1:      SHA1Init(&context->sha1);           break;
+  case HASH_ID_SHA256:    SHA256Init(&context->sha256);       break;
+  case HASH_ID_RIPEMD160: RIPEMD160Init(&context->ripemd160); break;
+  case HASH_ID_BLAKE2S:   BLAKE2sInit(&context->blake2s);     break;
+}
+return HashDigestBytes(alg);
+}
+// --------------------------------------------------------------------------------
+void HashAnyUpdate(HASH_ANY_CTX * context,char * input,uint16_t inputLen)
+{
+switch (context->alg) {
+  case HASH_ID_MD5:       MD5Update(&context->md5,input,inputLen);             break;
+  case HASH_ID_SHA1:      SHA1Update(&context->sha1,input,inputLen);           break;
+  case HASH_ID_SHA256:    SHA256Update(&context->sha256,input,inputLen);       break;
+  case HASH_ID_RIPEMD160: RIPEMD160Update(&context->ripemd160,input,inputLen); break;
+  case HASH_ID_BLAKE2S:   BLAKE2sUpdate(&context->blake2s,input,inputLen);     break;
+}
+}
+// --------------------------------------------------------------------------------
+void HashAnyFinal(HASH_ANY_CTX * context)
+{ // Result in buffer, as for each algorithm's own Final()
+switch (context->alg) {
+  case HASH_ID_MD5:       MD5Final(&context->md5);             break;
+  case HASH_ID_SHA1:      SHA1Final(&context->sha1);           break;
+  case HASH_ID_SHA256:    SHA256Final(&context->sha256);       break;
+  case HASH_ID_RIPEMD160: RIPEMD160Final(&context->ripemd160); break;
+  case HASH_ID_BLAKE2S:   BLAKE2sFinal(&context->blake2s);     break;
+}
+}
+// --------------------------------------------------------------------------------
+uint8_t HashOne(uint8_t alg,char * data,uint32_t len)
+{ // Hashes one whole message with alg, leaving the result in buffer.  Returns the
+  // result size, or 0 (buffer untouched) if alg is not known.
+HASH_ANY_CTX ctx;
+
+if (HashAnyInit(&ctx,alg)==0) return 0;
+for (;len>UPDATE_MAX;len-=UPDATE_MAX,data+=UPDATE_MAX) HashAnyUpdate(&ctx,data,UPDATE_MAX);
+HashAnyUpdate(&ctx,data,len);
+HashAnyFinal(&ctx);
+return HashDigestBytes(alg);
+}
+// --------------------------------------------------------------------------------
+void HashBatch(HASH_JOB * jobs,uint32_t n,char * output,uint8_t threads)
+{ // Digest of jobs[i] to output[i*HASH_BATCH_STRIDE], zero padded to the stride (and
+  // all zero for an unknown algorithm).  threads 0 means PoolThreads().
+uint32_t bounds[POOL_MAX_CHUNKS+1];
+uint32_t chunks=0;
+uint64_t total=0,target,weight=0;
+BATCH    batch;
+
+if (threads==0) threads=PoolThreads();
+for (uint32_t i=0;i<n;i++) total+=jobs[i].len+HASH_JOB_OVERHEAD;
+target=total/((uint32_t)threads*POOL_CHUNKS_PER_THREAD)+1;
+
+bounds[0]=0;
+for (uint32_t i=0;i<n;i++) {  // Cut when a chunk reaches its share of the weight
+  weight+=jobs[i].len+HASH_JOB_OVERHEAD;
+  if (weight>=target && chunks<POOL_MAX_CHUNKS-1) {
+    bounds[++chunks]=i+1;
+    weight=0;
+  }
+}
+if (bounds[chunks]<n) bounds[++chunks]=n;
+
+batch.jobs=jobs;
+batch.output=output;
+PoolRun(HashChunk,&batch,bounds,chunks,threads);
+}
+// --------------------------------------------------------------------------------
+uint8_t HashKnownAnswers(void)
+{ // Hashes two fixed messages with every HASH_ID_xxx through HashBatch() (so through
+  // the lanes too, with HASH_LANES) and checks the digests.  Returns 1 if all match,
+  // 0 if this build gives wrong digests.
+HASH_JOB jobs[2*HASH_ID_BLAKE2S];
+char     message[KNOWN_LONG];
+char     output[2*HASH_ID_BLAKE2S*HASH_BATCH_STRIDE];
+
+for (uint8_t i=0;i<KNOWN_LONG;i++) message[i]=i*37+11;
+for (uint8_t j=0;j<2*HASH_ID_BLAKE2S;j++) {
+  jobs[j].data=(j&1)?message:"abc";
+  jobs[j].len=(j&1)?KNOWN_LONG:3;
+  jobs[j].alg=j/2+HASH_ID_MD5;
+}
+HashBatch(jobs,2*HASH_ID_BLAKE2S,output,1);
+
+for (uint8_t j=0;j<2*HASH_ID_BLAKE2S;j++)
+  for (uint8_t i=0;i<HashDigestBytes(jobs[j].alg);i++) {
+    uint8_t c=output[j*HASH_BATCH_STRIDE+i];
+    if (Known[j][2*i]!="0123456789abcdef"[c>>4] || Known[j][2*i+1]!="0123456789abcdef"[c&0xF])
+      return 0;
+  }
+return 1;
+}
+// --------------------------------------------------------------------------------
+static void HashChunk(void * arg,uint32_t first,uint32_t last)
+{
+BATCH * batch=(BATCH *)arg;
+
+#ifdef HASH_LANES  // MD5 and RIPEMD160 jobs interleaved, see lanes.c
+HashLanes(&batch->jobs[first],last-first,&batch->output[first*HASH_BATCH_STRIDE],HASH_LANES);
+#else
+for (uint32_t i=first;i<last;i++) {
+  char *  out=&batch->output[i*HASH_BATCH_STRIDE];
+  uint8_t size=HashOne(batch->jobs[i].alg,batch->jobs[i].data,batch->jobs[i].len);
+
+  memcpy(out,buffer,size);
+  memset(&out[size],0,HASH_BATCH_STRIDE-size);
+}
+#endif
+}
@@ -0,0 +1,42 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "md5.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "ripemd160.h"
+#include "blake2s.h"
+
+// One message of a batch
+typedef struct {
+  char *   data;
+  uint32_t len;
+  uint8_t  alg;          // HASH_ID_xxx
+} HASH_JOB;
+
+// Context for any of the algorithms, chosen at run time
+typedef struct {
+  union {
+    MD5_CTX       md5;
+    SHA1_CTX      sha1;
+    SHA256_CTX    sha256;
+    RIPEMD160_CTX ripemd160;
+    BLAKE2S_CTX   blake2s;
+  };
+  uint8_t alg;           // HASH_ID_xxx
+} HASH_ANY_CTX;
+
+#define HASH_BATCH_STRIDE  (32)  // Output bytes per job, any algorithm (SHA256_RESULT_BYTES)
+#define HASH_JOB_OVERHEAD  (64)  // Weight of a job's Init and Final in bytes, for balancing
+
+uint8_t HashDigestBytes(uint8_t alg);
+uint8_t HashAnyInit(HASH_ANY_CTX *,uint8_t alg);
+void    HashAnyUpdate(HASH_ANY_CTX *,char * data,uint16_t length);
+void    HashAnyFinal(HASH_ANY_CTX *);
+uint8_t HashOne(uint8_t alg,char * data,uint32_t len);
+void    HashBatch(HASH_JOB * jobs,uint32_t n,char * output,uint8_t threads);
+uint8_t HashKnownAnswers(void);
+
+#endif
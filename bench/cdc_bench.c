@@ -0,0 +1,120 @@
+/* Host benchmark and check of CDCChunkAll() against the streaming chunker
+
+   Chunks 24MB of pseudo random data (with runs of zeros and a duplicated region)
+   both ways, at several lengths and thread counts, checks the chunk lists are
+   identical, then times each.
+
+     gcc -std=gnu99 -O2 -funsigned-char -I.. -DHASH_THREADS cdc_bench.c ../cdc.c ../sha256.c ../pool.c -lpthread
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cdc.h"
+
+#define LENGTH  (24UL<<20)
+
+HASH_TLS char buffer[MSG_LENGTH];
+char hex[]="0123456789ABCDEF";
+
+static uint64_t Random(uint64_t * seed);
+static double   Now(void);
+static uint32_t Streaming(char * data,uint32_t length,CDC_CHUNK * chunks);
+
+// --------------------------------------------------------------------------------
+int main(void)
+{
+char * data=malloc(LENGTH);
+uint32_t slots=CDCSlots(LENGTH);
+CDC_CHUNK * chunks=malloc(slots*sizeof(CDC_CHUNK));
+CDC_CHUNK * scratch=malloc(slots*sizeof(CDC_CHUNK));
+CDC_CHUNK * expect=malloc(slots*sizeof(CDC_CHUNK));
+uint32_t lengths[]={0,1,CDC_MIN_BYTES-1,CDC_MIN_BYTES,CDC_SEGMENT_BYTES-1,CDC_SEGMENT_BYTES,
+                    CDC_SEGMENT_BYTES+1,3*CDC_SEGMENT_BYTES+77,LENGTH};
+uint64_t seed=1;
+uint32_t bad=0;
+double t0;
+
+for (uint32_t i=0;i<LENGTH;i++) data[i]=Random(&seed);
+for (uint32_t i=0;i<LENGTH/8;i+=4096) memset(&data[i*3],0,1500);  // Runs forcing maximum chunks
+memcpy(&data[5UL<<20],data,3UL<<20);                               // Duplicated region
+
+for (uint8_t l=0;l<sizeof(lengths)/sizeof(lengths[0]);l++) {
+  uint32_t n=Streaming(data,lengths[l],expect);
+  for (uint8_t threads=1;threads<=9;threads+=4)
+    if (CDCChunkAll(data,lengths[l],chunks,scratch,threads)!=n ||
+        memcmp(chunks,expect,n*sizeof(CDC_CHUNK))) {
+      printf("Mismatch at length %lu, %u threads\n",(unsigned long)lengths[l],threads);
+      bad++;
+    }
+}
+printf("%s\n",bad?"FAILED":"Chunk lists identical");
+
+t0=Now();
+for (uint8_t r=0;r<3;r++) Streaming(data,LENGTH,expect);
+printf("Streaming        %6.0f MB/s\n",3*(LENGTH>>20)/(Now()-t0));
+for (uint8_t threads=1;threads<=8;threads*=2) {
+  t0=Now();
+  for (uint8_t r=0;r<3;r++) CDCChunkAll(data,LENGTH,chunks,scratch,threads);
+  printf("Pool, %u threads  %6.0f MB/s\n",threads,3*(LENGTH>>20)/(Now()-t0));
+}
+return bad!=0;
+}
+// --------------------------------------------------------------------------------
+static uint32_t Streaming(char * data,uint32_t length,CDC_CHUNK * chunks)
+{ // Chunk list from CDCUpdate()/CDCFinal(), fed up to 1000 chars at a time
+CDC_CTX cdc;
+uint32_t n=0,offset=0;
+
+CDCInit(&cdc);
+while (length) {
+  uint16_t used=CDCUpdate(&cdc,data,(length>1000)?1000:length);
+  data+=used;
+  length-=used;
+  if (cdc.ready) {
+    chunks[n].offset=offset;
+    chunks[n].size=cdc.size;
+    memcpy(chunks[n++].digest,buffer,SHA256_RESULT_BYTES);
+    offset+=cdc.size;
+  }
+}
+if (CDCFinal(&cdc)) {
+  chunks[n].offset=offset;
+  chunks[n].size=cdc.size;
+  memcpy(chunks[n++].digest,buffer,SHA256_RESULT_BYTES);
+}
+return n;
+}
+// --------------------------------------------------------------------------------
+static uint64_t Random(uint64_t * seed)
+{ // splitmix64
+uint64_t z=(*seed+=0x9e3779b97f4a7c15ULL);
+z=(z^(z>>30))*0xbf58476d1ce4e5b9ULL;
+z=(z^(z>>27))*0x94d049bb133111ebULL;
+return z^(z>>31);
+}
+// --------------------------------------------------------------------------------
+static double Now(void)
+{
+struct timespec t;
+
+clock_gettime(CLOCK_MONOTONIC,&t);
+return t.tv_sec+t.tv_nsec*1e-9;
+}
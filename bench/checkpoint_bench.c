@@ -0,0 +1,122 @@
+/* Host benchmark of resuming SHA-256 from a checkpoint on a growing log
+
+   Grows a log file by equal appends up to the given size (default 10GB in 10
+   appends).  After each append the digest of the whole log is brought up to date
+   by restoring the checkpoint kept beside it, hashing only the new bytes and saving
+   the checkpoint again.  At the end the whole log is hashed from zero once, for
+   comparison, and the two digests are checked to agree.  Rehashing from zero after
+   every append would cost that last time multiplied by about (appends+1)/2.
+
+     gcc -std=gnu99 -O2 -funsigned-char -I.. checkpoint_bench.c ../checkpoint.c ../sha256.c
+     ./a.out /tmp/log 10240 10     // Path, final size in MB, appends
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define _POSIX_C_SOURCE 200809L  // pread
+
+#include "config.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "checkpoint.h"
+#include "sha256.h"
+
+#define BLOCK  (1UL<<20)  // Per write() and pread()
+#define PIECE  (32768)    // Per SHA256Update()
+
+HASH_TLS char buffer[MSG_LENGTH];
+char hex[]="0123456789ABCDEF";
+
+static char data[BLOCK];
+
+static double Now(void);
+static void   HashFrom(SHA256_CTX * ctx,int fd,uint64_t offset,uint64_t end);
+
+// --------------------------------------------------------------------------------
+int main(int argc,char ** argv)
+{
+const char * path=(argc>1)?argv[1]:"/tmp/checkpoint_bench.log";
+uint64_t total=((argc>2)?strtoull(argv[2],NULL,10):10240)<<20;
+uint32_t appends=(argc>3)?strtoul(argv[3],NULL,10):10;
+uint64_t size=0,seed=1;
+char     store[HASH_CHECKPOINT_MAX],resumed[SHA256_RESULT_BYTES];
+double   resumeTime=0,t0;
+SHA256_CTX ctx;
+int      fd=open(path,O_RDWR|O_CREAT|O_TRUNC,0644);
+
+if (fd<0 || appends==0) {
+  printf("Usage : checkpoint_bench [path [MB [appends]]]\n");
+  return 1;
+}
+SHA256Init(&ctx);                     // Checkpoint of the empty log
+SHA256Save(&ctx,store);
+
+for (uint32_t a=1;a<=appends;a++) {
+  uint64_t end=total/appends*a;
+  double   t;
+
+  for (;size<end;size+=BLOCK) {       // Append : pseudo random log data
+    for (uint32_t i=0;i<BLOCK;i+=8) {
+      seed=seed*6364136223846793005ULL+1442695040888963407ULL;
+      memcpy(&data[i],&seed,8);
+    }
+    if (write(fd,data,(end-size<BLOCK)?end-size:BLOCK)<0) return 1;
+  }
+  size=end;
+
+  t0=Now();                           // Resume : only the appended bytes
+  SHA256Restore(&ctx,store);
+  HashFrom(&ctx,fd,HashCheckpointBytes(store),size);
+  SHA256Save(&ctx,store);
+  SHA256Final(&ctx);
+  t=Now()-t0;
+  resumeTime+=t;
+  memcpy(resumed,buffer,SHA256_RESULT_BYTES);
+  printf("Append %3lu : log %7.0f MB, resumed in %7.2f s\n",(unsigned long)a,size/1048576.0,t);
+}
+
+t0=Now();                             // Once from zero, for comparison
+SHA256Init(&ctx);
+HashFrom(&ctx,fd,0,size);
+SHA256Final(&ctx);
+printf("Whole log from zero                %7.2f s, digests %s\n",Now()-t0,
+       memcmp(resumed,buffer,SHA256_RESULT_BYTES)?"DIFFER":"agree");
+printf("All %lu resumes                    %7.2f s\n",(unsigned long)appends,resumeTime);
+close(fd);
+return 0;
+}
+// --------------------------------------------------------------------------------
+static void HashFrom(SHA256_CTX * ctx,int fd,uint64_t offset,uint64_t end)
+{ // Hashes the file from offset to end
+while (offset<end) {
+  ssize_t n=pread(fd,data,(end-offset<BLOCK)?end-offset:BLOCK,offset);
+  if (n<=0) return;
+  for (ssize_t i=0;i<n;i+=PIECE) SHA256Update(ctx,&data[i],(n-i<PIECE)?n-i:PIECE);
+  offset+=n;
+}
+}
+// --------------------------------------------------------------------------------
+static double Now(void)
+{
+struct timespec t;
+
+clock_gettime(CLOCK_MONOTONIC,&t);
+return t.tv_sec+t.tv_nsec*1e-9;
+}
@@ -0,0 +1,106 @@
+/* Host benchmark of DigestSetContains() and DigestSetContainsBatch() latency
+
+   For 1M and 4M random digests of 16, 20 and 32 bytes, builds a set with about one
+   digest per prefix bucket and times 1M lookups, half of them present, singly and
+   as one batch.  Reports ns per lookup, bytes per entry and the build time.
+
+     gcc -std=gnu99 -O2 -funsigned-char -I.. digestset_bench.c ../digestset.c
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "digestset.h"
+
+#define QUERIES  (1000000UL)
+
+HASH_TLS char buffer[MSG_LENGTH];
+char hex[]="0123456789ABCDEF";
+
+static void   Random(char * p,size_t n);
+static double Now(void);
+
+// --------------------------------------------------------------------------------
+int main(void)
+{
+uint32_t counts[]={1000000,4000000};
+uint8_t  sizes[]={16,20,32};
+
+printf("entries  size  bytes/entry  single ns  batch ns  build s\n");
+for (uint8_t c=0;c<2;c++)
+  for (uint8_t s=0;s<3;s++) {
+    uint32_t n=counts[c],hits=0,batchHits=0;
+    uint8_t  size=sizes[s],bits=0;
+    char *   digests=malloc((size_t)n*size);
+    char *   queries=malloc((size_t)QUERIES*size);
+    uint8_t * result=malloc(QUERIES);
+    uint32_t * offsets;
+    DIGEST_SET set;
+    double   t0,build,single,batch;
+
+    while ((1UL<<(bits+1))<=n) bits++;  // About one digest per bucket
+    offsets=malloc(((1UL<<bits)+1)*sizeof(uint32_t));
+    Random(digests,(size_t)n*size);
+    for (uint32_t i=0;i<QUERIES;i++)    // Half present, scattered
+      if (i&1) memcpy(&queries[(size_t)i*size],&digests[(size_t)((i*2654435761UL)%n)*size],size);
+      else Random(&queries[(size_t)i*size],size);
+
+    t0=Now();
+    DigestSetBuild(&set,digests,n,size,offsets,bits);
+    build=Now()-t0;
+    t0=Now();
+    for (uint32_t i=0;i<QUERIES;i++) hits+=DigestSetContains(&set,&queries[(size_t)i*size]);
+    single=Now()-t0;
+    t0=Now();
+    DigestSetContainsBatch(&set,queries,QUERIES,result);
+    batch=Now()-t0;
+    for (uint32_t i=0;i<QUERIES;i++) batchHits+=result[i];
+
+    printf("%4luM    %4u  %9.1f  %9.1f  %8.1f  %7.2f%s\n",(unsigned long)n/1000000,size,
+           (double)DigestSetBytes(&set)/set.count,single*1e9/QUERIES,batch*1e9/QUERIES,build,
+           (hits==batchHits && hits>=QUERIES/2)?"":"  MISMATCH");
+    free(digests);
+    free(queries);
+    free(result);
+    free(offsets);
+  }
+return 0;
+}
+// --------------------------------------------------------------------------------
+static void Random(char * p,size_t n)
+{ // splitmix64
+static uint64_t seed=1;
+
+for (size_t i=0;i<n;i+=8) {
+  uint64_t z=(seed+=0x9e3779b97f4a7c15ULL);
+  z=(z^(z>>30))*0xbf58476d1ce4e5b9ULL;
+  z=(z^(z>>27))*0x94d049bb133111ebULL;
+  z^=z>>31;
+  memcpy(&p[i],&z,(n-i<8)?n-i:8);
+}
+}
+// --------------------------------------------------------------------------------
+static double Now(void)
+{
+struct timespec t;
+
+clock_gettime(CLOCK_MONOTONIC,&t);
+return t.tv_sec+t.tv_nsec*1e-9;
+}
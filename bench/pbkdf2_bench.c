@@ -0,0 +1,98 @@
+/* Host benchmark of PBKDF2 throughput, in iterations per second
+
+   Compares one HMAC per iteration set up from the key each time (four Transforms),
+   PBKDF2SHA1()/PBKDF2SHA256() on the keyed midstates (two Transforms), and
+   PBKDF2Batch() deriving 32 keys on 1, 2 and 4 threads.  Build with and without
+   HASH_THREADS to compare the pool against serial running.
+
+     gcc -std=gnu99 -O2 -funsigned-char -I.. -DHASH_THREADS pbkdf2_bench.c ../pbkdf2.c ../hmac.c ../sha1.c ../sha256.c ../pool.c -lpthread
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <time.h>
+#include "pbkdf2.h"
+
+#define ITERATIONS  (100000UL)
+#define KEYS        (32)
+#define BATCH_ITERATIONS  (20000UL)  // Per key
+
+HASH_TLS char buffer[MSG_LENGTH];
+char hex[]="0123456789ABCDEF";
+
+static double Now(void);
+
+// --------------------------------------------------------------------------------
+int main(void)
+{
+char password[KEYS][16],salt[KEYS][16],output[KEYS][32];
+PBKDF2_JOB jobs[KEYS];
+HMAC_SHA1_CTX   sha1;
+HMAC_SHA256_CTX sha256;
+double t0;
+
+for (uint8_t k=0;k<KEYS;k++) {
+  for (uint8_t i=0;i<16;i++) {
+    password[k][i]='a'+(k+i)%26;
+    salt[k][i]=k*16+i;
+  }
+  jobs[k].password=password[k];
+  jobs[k].passwordLength=8+k%8;
+  jobs[k].salt=salt[k];
+  jobs[k].saltLength=16;
+  jobs[k].output=output[k];
+}
+
+t0=Now();
+for (uint32_t i=0;i<ITERATIONS;i++) {
+  HMACSHA1Init(&sha1,"password",8);
+  HMACSHA1Short(&sha1,buffer,SHA1_RESULT_BYTES);
+}
+printf("HMAC-SHA1 per iteration      %8.0f it/s\n",ITERATIONS/(Now()-t0));
+t0=Now();
+for (uint32_t i=0;i<ITERATIONS;i++) {
+  HMACSHA256Init(&sha256,"password",8);
+  HMACSHA256Short(&sha256,buffer,SHA256_RESULT_BYTES);
+}
+printf("HMAC-SHA256 per iteration    %8.0f it/s\n",ITERATIONS/(Now()-t0));
+
+t0=Now();
+PBKDF2SHA1("password",8,"IEEE",4,ITERATIONS,output[0],SHA1_RESULT_BYTES);
+printf("PBKDF2SHA1, midstates        %8.0f it/s\n",ITERATIONS/(Now()-t0));
+t0=Now();
+PBKDF2SHA256("password",8,"IEEE",4,ITERATIONS,output[0],SHA256_RESULT_BYTES);
+printf("PBKDF2SHA256, midstates      %8.0f it/s\n",ITERATIONS/(Now()-t0));
+
+for (uint8_t threads=1;threads<=4;threads*=2) {
+  t0=Now();
+  PBKDF2Batch(jobs,KEYS,HASH_ID_SHA1,BATCH_ITERATIONS,SHA1_RESULT_BYTES,threads);
+  printf("PBKDF2Batch SHA1, %u threads   %8.0f it/s\n",threads,KEYS*BATCH_ITERATIONS/(Now()-t0));
+  t0=Now();
+  PBKDF2Batch(jobs,KEYS,HASH_ID_SHA256,BATCH_ITERATIONS,SHA256_RESULT_BYTES,threads);
+  printf("PBKDF2Batch SHA256, %u threads %8.0f it/s\n",threads,KEYS*BATCH_ITERATIONS/(Now()-t0));
+}
+return 0;
+}
+// --------------------------------------------------------------------------------
+static double Now(void)
+{
+struct timespec t;
+
+clock_gettime(CLOCK_MONOTONIC,&t);
+return t.tv_sec+t.tv_nsec*1e-9;
+}
@@ -0,0 +1,173 @@
+/* Host simulation of the sliced (bounded latency) SHA-256 and RIPEMD-160 API
+
+   Streams a 64KB message through SHA256Slice*() and RIPEMD160Slice*() as a main loop
+   would, one call per pass, for several rounds per call.  Times every call and
+   reports the worst and 99.9th percentile call, the number of calls, and the total
+   time against the monolithic Update/Final (the overhead of slicing), each total the
+   best of RUNS.  The worst call includes any preemption of the process.  Digests are
+   checked against the monolithic ones.  Times are x86 TSC cycles (elsewhere ns).
+
+     gcc -std=gnu99 -O2 -funsigned-char -I.. slice_bench.c ../sha256.c ../ripemd160.c
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sha256.h"
+#include "ripemd160.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS()  __rdtsc()
+#else
+#define TICKS()  Ns()
+#define NEED_NS
+#endif
+
+#define LENGTH   (65536UL)
+#define PIECE    (1024)       // Chars offered per call, as from a receive buffer
+#define MAX_CALLS (LENGTH*2)  // 1 round per call : 64 or 80 per block, plus copies
+#define RUNS     (5)          // Totals are the best of these
+
+HASH_TLS char buffer[MSG_LENGTH];
+char hex[]="0123456789ABCDEF";
+
+static char     data[LENGTH];
+static uint64_t tick[MAX_CALLS];
+
+#ifdef NEED_NS
+static uint64_t Ns(void);
+#endif
+static int      Compare(const void * a,const void * b);
+static void     Report(const char * name,uint8_t rounds,uint32_t calls,uint64_t total,uint64_t whole,uint8_t ok);
+
+// --------------------------------------------------------------------------------
+int main(void)
+{
+uint8_t rounds[]={0,1,4,8,16,32,80};
+char    expect[SHA256_RESULT_BYTES];
+uint64_t whole,t0;
+
+for (uint32_t i=0;i<LENGTH;i++) data[i]=i*7+(i>>9);
+printf("           rounds  calls   worst  p99.9  total/monolithic\n");
+
+{ // SHA-256
+SHA256_CTX ctx;
+whole=~0ULL;
+for (uint8_t run=0;run<RUNS;run++) {
+  t0=TICKS();
+  SHA256Init(&ctx);
+  for (uint32_t i=0;i<LENGTH;i+=PIECE) SHA256Update(&ctx,&data[i],PIECE);
+  SHA256Final(&ctx);
+  if (TICKS()-t0<whole) whole=TICKS()-t0;
+}
+memcpy(expect,buffer,SHA256_RESULT_BYTES);
+
+for (uint8_t r=0;r<sizeof(rounds);r++) {
+  SHA256_SLICE_CTX slice;
+  uint32_t calls=0,done;
+  uint64_t total=~0ULL,sum;
+
+  for (uint8_t run=0;run<RUNS;run++) {  // Keeps the call times of the last run
+    calls=done=sum=0;
+    SHA256SliceInit(&slice);
+    while (done<LENGTH) {                  // Main loop : one bounded call per pass
+      uint32_t piece=PIECE-done%PIECE;
+      t0=TICKS();
+      done+=SHA256SliceUpdate(&slice,&data[done],piece,rounds[r]);
+      tick[calls]=TICKS()-t0;
+      sum+=tick[calls++];
+    }
+    for (uint8_t finished=0;!finished;) {
+      t0=TICKS();
+      finished=SHA256SliceFinal(&slice,rounds[r]);
+      tick[calls]=TICKS()-t0;
+      sum+=tick[calls++];
+    }
+    if (sum<total) total=sum;
+  }
+  Report("SHA256",rounds[r],calls,total,whole,!memcmp(expect,buffer,SHA256_RESULT_BYTES));
+}
+}
+
+{ // RIPEMD-160
+RIPEMD160_CTX ctx;
+whole=~0ULL;
+for (uint8_t run=0;run<RUNS;run++) {
+  t0=TICKS();
+  RIPEMD160Init(&ctx);
+  for (uint32_t i=0;i<LENGTH;i+=PIECE) RIPEMD160Update(&ctx,&data[i],PIECE);
+  RIPEMD160Final(&ctx);
+  if (TICKS()-t0<whole) whole=TICKS()-t0;
+}
+memcpy(expect,buffer,RIPEMD160_RESULT_BYTES);
+
+for (uint8_t r=0;r<sizeof(rounds);r++) {
+  RIPEMD160_SLICE_CTX slice;
+  uint32_t calls=0,done;
+  uint64_t total=~0ULL,sum;
+
+  for (uint8_t run=0;run<RUNS;run++) {  // Keeps the call times of the last run
+    calls=done=sum=0;
+    RIPEMD160SliceInit(&slice);
+    while (done<LENGTH) {
+      uint32_t piece=PIECE-done%PIECE;
+      t0=TICKS();
+      done+=RIPEMD160SliceUpdate(&slice,&data[done],piece,rounds[r]);
+      tick[calls]=TICKS()-t0;
+      sum+=tick[calls++];
+    }
+    for (uint8_t finished=0;!finished;) {
+      t0=TICKS();
+      finished=RIPEMD160SliceFinal(&slice,rounds[r]);
+      tick[calls]=TICKS()-t0;
+      sum+=tick[calls++];
+    }
+    if (sum<total) total=sum;
+  }
+  Report("RIPEMD160",rounds[r],calls,total,whole,!memcmp(expect,buffer,RIPEMD160_RESULT_BYTES));
+}
+}
+return 0;
+}
+// --------------------------------------------------------------------------------
+static void Report(const char * name,uint8_t rounds,uint32_t calls,uint64_t total,uint64_t whole,uint8_t ok)
+{ // Includes the timing calls themselves, a few tens of cycles each
+qsort(tick,calls,sizeof(tick[0]),Compare);
+printf("%-10s %6u %6lu %7lu %6lu %9.2f%s\n",name,rounds,(unsigned long)calls,
+       (unsigned long)tick[calls-1],(unsigned long)tick[calls-1-calls/1000],
+       (double)total/whole,ok?"":"  WRONG DIGEST");
+}
+// --------------------------------------------------------------------------------
+static int Compare(const void * a,const void * b)
+{
+uint64_t x=*(const uint64_t *)a,y=*(const uint64_t *)b;
+
+return (x>y)-(x<y);
+}
+#ifdef NEED_NS
+// --------------------------------------------------------------------------------
+static uint64_t Ns(void)
+{
+struct timespec t;
+
+clock_gettime(CLOCK_MONOTONIC,&t);
+return (uint64_t)t.tv_sec*1000000000+t.tv_nsec;
+}
+#endif
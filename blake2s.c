@@ -0,0 +1,261 @@
+/*  BLAKE2s-256 algorithm (RFC 7693), plain and keyed
+    Same interface and conventions as the other algorithms here : byte count,
+    partial block in buffer, result left in buffer.
+
+   Faster than SHA-256 on both 8 bit and 32 bit processors, for similar security :
+   10 rounds of 8 G functions rather than 64 rounds, and no message schedule.  On
+   AVR the 16 and 8 bit rotations are byte moves, and 12 and 7 bit rotations a byte
+   move plus a 4 or 1 bit shift, as the 8 bit processor does not have a barrel
+   shifter.  Elsewhere they are plain 32 bit rotations.
+
+   Unlike the Merkle-Damgard hashes, the last block is flagged in its compression,
+   so a full block is held in buffer until more data arrives or BLAKE2sFinal() is
+   called.  Keyed mode (BLAKE2sInitKey()) is a MAC, in place of HMAC at a quarter of
+   its cost : one extra block, not two extra hashes.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "blake2s.h"
+#include "stats.h"
+#include <string.h> // memcpy
+
+#define STATS_ID  (HASH_ID_BLAKE2S)  // For stats.h
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+static void BLAKE2sCompress(BLAKE2S_CTX * context,char * input,uint8_t last);
+static inline void G(JOINED * v,uint8_t a,uint8_t b,uint8_t c,uint8_t d,uint32_t x,uint32_t y);
+static void AddCount(BLAKE2S_CTX * context,uint16_t n);
+static uint8_t Pending(BLAKE2S_CTX * context);
+
+#define ROTR(x,n) (((x)>>(n))|((x)<<(32-(n))))  // Works on uint32_t
+#define M(i)      (m[ROM_BYTE(SIGMA[round][(i)])].word32)  // Message word i of this round
+
+#ifdef __AVR__   // Rotations in place on JOINED, by moving bytes where possible
+#define ROTR8(x)  ({ uint8_t tmp=(x).lsb;(x).lsb=(x).slsb;(x).slsb=(x).smsb;(x).smsb=(x).msb;(x).msb=tmp; })
+#define ROTR16(x) ({ uint8_t tmp=(x).lsb;(x).lsb=(x).smsb;(x).smsb=tmp;\
+                            tmp=(x).slsb;(x).slsb=(x).msb;(x).msb=tmp; })
+#define ROTR12(x) ({ ROTR8(x);(x).word32=ROTR((x).word32,4); })
+#define ROTR7(x)  ({ ROTR8(x);(x).word32=ROTR((x).word32,31); })  // i.e. left by 1
+#else
+#define ROTR8(x)  ((x).word32=ROTR((x).word32,8))
+#define ROTR16(x) ((x).word32=ROTR((x).word32,16))
+#define ROTR12(x) ((x).word32=ROTR((x).word32,12))
+#define ROTR7(x)  ((x).word32=ROTR((x).word32,7))
+#endif
+
+static const uint32_t IV[8] ROM={0x6a09e667,0xbb67ae85,0x3c6ef372,0xa54ff53a,  // As SHA-256
+                                 0x510e527f,0x9b05688c,0x1f83d9ab,0x5be0cd19};
+
+static const uint8_t SIGMA[10][16] ROM={  // Message word order, per round
+             { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15},
+             {14,10, 4, 8, 9,15,13, 6, 1,12, 0, 2,11, 7, 5, 3},
+             {11, 8,12, 0, 5, 2,15,13,10,14, 3, 6, 7, 1, 9, 4},
+             { 7, 9, 3, 1,13,12,11,14, 2, 6, 5,10, 4, 0,15, 8},
+             { 9, 0, 5, 7, 2, 4,10,15,14, 1,11,12, 6, 8, 3,13},
+             { 2,12, 6,10, 0,11, 8, 3, 4,13, 7, 5,15,14, 1, 9},
+             {12, 5, 1,15,14,13, 4,10, 0, 7, 6, 3, 9, 2, 8,11},
+             {13,11, 7,14,12, 1, 3, 9, 5, 0,15, 4, 8, 6, 2,10},
+             { 6,15,14, 9,11, 3, 0, 8,12, 2,13, 7, 1, 4,10, 5},
+             {10, 2, 8, 4, 7, 6, 1, 5,15,11, 9,14, 3,12,13, 0}};
+// --------------------------------------------------------------------------------
+void BLAKE2sInit(BLAKE2S_CTX * context)
+{ 
+BLAKE2sInitKey(context,NULL,0);
+}
+// --------------------------------------------------------------------------------
+uint8_t BLAKE2sInitKey(BLAKE2S_CTX * context,char * key,uint8_t keyLen)
+{ // Keyed hash (MAC) with a key of 1..BLAKE2S_KEY_BYTES chars, or plain hash if keyLen=0.
+  // Returns 1, or 0 (context untouched) if the key is too long.
+if (keyLen>BLAKE2S_KEY_BYTES) return 0;
+
+context->count[0]=context->count[1]=0;
+
+for (uint8_t i=0;i<8;i++) context->H[i].word32=ROM_WORD32(IV[i]);
+context->H[0].word32^=0x01010000^((uint32_t)keyLen<<8)^BLAKE2S_RESULT_BYTES;  // Parameter block
+
+if (keyLen) {  // Key, zero padded, is a whole first block
+  memset(&buffer[BLAKE2S_BUF_OFFSET],0,BLAKE2S_INPUT_BYTES);
+  memcpy(&buffer[BLAKE2S_BUF_OFFSET],key,keyLen);
+  context->count[BLAKE2S_LSW]=BLAKE2S_INPUT_BYTES;
+}
+return 1;
+}
+// --------------------------------------------------------------------------------
+void BLAKE2sUpdate(BLAKE2S_CTX * context,char * input,uint16_t inputLen) 
+{ // Adds inputLen characters to the hash.  A block in buffer is only compressed once
+  // more data follows it, as the last block must be compressed by BLAKE2sFinal().
+uint16_t i=0; 
+uint8_t  index;
+STATS_START(t0);
+
+index=Pending(context);
+STATS_ADD(updates,1);
+STATS_ADD(bytes,inputLen);
+
+if (index+inputLen>BLAKE2S_INPUT_BYTES) {  // So buffer's block is not the last
+  i=BLAKE2S_INPUT_BYTES-index;
+  memcpy(&buffer[BLAKE2S_BUF_OFFSET+index],input,i);       // Fill rest of line
+  STATS_ADD(partialBlocks,(index!=0));
+  STATS_ADD(copied,i);
+  AddCount(context,i);
+  BLAKE2sCompress(context,&buffer[BLAKE2S_BUF_OFFSET],0);
+
+  for (;inputLen-i>BLAKE2S_INPUT_BYTES;i+=BLAKE2S_INPUT_BYTES) {  // Whole lines, not last
+    STATS_ADD(fullBlocks,1);
+    AddCount(context,BLAKE2S_INPUT_BYTES);
+    BLAKE2sCompress(context,&input[i],0);
+  }
+  index=0;
+}
+memcpy(&buffer[BLAKE2S_BUF_OFFSET+index],&input[i],inputLen-i);  // Leftovers, maybe a whole line
+STATS_ADD(copied,inputLen-i);
+AddCount(context,inputLen-i);
+STATS_STOP(STATS_PHASE_UPDATE,t0);
+}
+// -------------------------------------------------------------------------------- 
+void BLAKE2sFinal(BLAKE2S_CTX * context)
+{
+uint8_t index;
+STATS_START(t0);
+
+index=Pending(context);
+memset(&buffer[BLAKE2S_BUF_OFFSET+index],0,BLAKE2S_INPUT_BYTES-index);  // Zero padding only
+BLAKE2sCompress(context,&buffer[BLAKE2S_BUF_OFFSET],1);
+
+// State is now the result.  Littleendian into buffer for first BLAKE2S_RESULT_BYTES
+for (uint8_t i=0,j=0;j<BLAKE2S_RESULT_BYTES;i++) {
+  buffer[j++]=context->H[i].lsb;
+  buffer[j++]=context->H[i].slsb;
+  buffer[j++]=context->H[i].smsb;
+  buffer[j++]=context->H[i].msb;
+}
+
+memset(context,0,sizeof(*context));   // Clean sensitive intermediates
+memset(&buffer[BLAKE2S_RESULT_BYTES],0,BLAKE2S_BUF_OFFSET+BLAKE2S_INPUT_BYTES-BLAKE2S_RESULT_BYTES);
+STATS_STOP(STATS_PHASE_FINAL,t0);
+}
+// --------------------------------------------------------------------------------
+static void BLAKE2sCompress(BLAKE2S_CTX * context,char * input,uint8_t last)
+{ // Compresses the block at input (which may be buffer's own block).  count must
+  // already include it.
+STATS_START(t0);
+JOINED v[16];                   // Local working vector
+JOINED * m=(JOINED *)buffer;    // Alias only
+
+for (uint8_t i=0,j=0;j<BLAKE2S_INPUT_BYTES;i++) {
+  m[i].lsb =input[j++];  // N.B. Designed so input can be buffer[BLAKE2S_BUF_OFFSET]
+  m[i].slsb=input[j++];
+  m[i].smsb=input[j++];
+  m[i].msb =input[j++];
+}
+
+memcpy(v,context->H,sizeof(context->H));
+for (uint8_t i=0;i<8;i++) v[i+8].word32=ROM_WORD32(IV[i]);
+v[12].word32^=context->count[BLAKE2S_LSW];
+v[13].word32^=context->count[BLAKE2S_MSW];
+if (last) v[14].word32=~v[14].word32;
+
+for (uint8_t round=0;round<10;round++) {
+#ifdef __AVR__   // Compact
+  for (uint8_t i=0;i<4;i++)      // Columns
+    G(v,i,i+4,i+8,i+12,M(2*i),M(2*i+1));
+  for (uint8_t i=0;i<4;i++)      // Diagonals
+    G(v,i,((i+1)&3)+4,((i+2)&3)+8,((i+3)&3)+12,M(2*i+8),M(2*i+9));
+#else            // Constant indices, so the working vector can stay in registers
+  G(v,0,4, 8,12,M( 0),M( 1));
+  G(v,1,5, 9,13,M( 2),M( 3));
+  G(v,2,6,10,14,M( 4),M( 5));
+  G(v,3,7,11,15,M( 6),M( 7));
+  G(v,0,5,10,15,M( 8),M( 9));
+  G(v,1,6,11,12,M(10),M(11));
+  G(v,2,7, 8,13,M(12),M(13));
+  G(v,3,4, 9,14,M(14),M(15));
+#endif
+}
+
+for (uint8_t i=0;i<8;i++) context->H[i].word32^=v[i].word32^v[i+8].word32;
+
+memset(buffer,0,MSG_LENGTH);  // Zeroise intermediate data (could defer this line)
+memset(v,0,sizeof(v));
+STATS_ADD(transforms,1);
+STATS_STOP(STATS_PHASE_TRANSFORM,t0);
+}
+// --------------------------------------------------------------------------------
+static inline void G(JOINED * v,uint8_t a,uint8_t b,uint8_t c,uint8_t d,uint32_t x,uint32_t y)
+{ // Mixing function, on 4 words of the working vector
+v[a].word32+=v[b].word32+x;
+v[d].word32^=v[a].word32;
+ROTR16(v[d]);
+v[c].word32+=v[d].word32;
+v[b].word32^=v[c].word32;
+ROTR12(v[b]);
+v[a].word32+=v[b].word32+y;
+v[d].word32^=v[a].word32;
+ROTR8(v[d]);
+v[c].word32+=v[d].word32;
+v[b].word32^=v[c].word32;
+ROTR7(v[b]);
+}
+// --------------------------------------------------------------------------------
+static void AddCount(BLAKE2S_CTX * context,uint16_t n)
+{
+if ((context->count[BLAKE2S_LSW]+=n)<n) context->count[BLAKE2S_MSW]++;  // Overflow
+}
+// --------------------------------------------------------------------------------
+static uint8_t Pending(BLAKE2S_CTX * context)
+{ // Characters waiting in buffer : 1..64 once anything has been added, as a whole
+  // block is held back in case it is the last
+uint8_t index=(((uint8_t)context->count[BLAKE2S_LSW])&0x3F);
+
+if (index==0 && (context->count[BLAKE2S_LSW]|context->count[BLAKE2S_MSW])) 
+  index=BLAKE2S_INPUT_BYTES;
+return index;
+}
+// --------------------------------------------------------------------------------
+/*
+To TEST in Debugger use main.c that reads:
+
+#include <avr/io.h>
+#include "hash.h"
+#include "blake2s.h"
+#include "config.h" // Which should at least read :
+
+// #define MSG_LENGTH (68)  
+// #define LITTLEENDIAN (1)
+
+// END OF config.h
+
+char buffer[MSG_LENGTH];
+char hex[]="0123456789ABCDEF";
+
+int main(void)
+{
+
+BLAKE2S_CTX blake2scontext;
+BLAKE2sInit(&blake2scontext);
+BLAKE2sUpdate(&blake2scontext,"abc",3);
+BLAKE2sFinal(&blake2scontext);
+// Expect 508c5e8c327c14e2e1a72ba34eeb452f37458b209ed63a294d999b4c86675982
+
+BLAKE2sInit(&blake2scontext);  // Only here to give Debugger a breakpoint
+// Inspect contents of buffer to see hash
+
+while (1)   {  }
+}
+*/
@@ -0,0 +1,28 @@
+#ifndef BLAKE2S_H
+#define BLAKE2S_H
+
+#include <stdint.h>
+#include "hash.h"
+
+// BLAKE2s-256 data (RFC 7693).  Plain or keyed (MAC).
+
+#define BLAKE2S_BUF_OFFSET     (4)
+#define BLAKE2S_INPUT_BYTES   (64)  // Input bytes at a time
+#define BLAKE2S_RESULT_BYTES  (32)  // Hash result size in bytes
+#define BLAKE2S_KEY_BYTES     (32)  // Maximum key size
+#define BLAKE2S_LSW            (0)  // Least significant word for size
+#define BLAKE2S_MSW            (1)
+
+typedef struct {
+  JOINED H[BLAKE2S_RESULT_BYTES/4];
+  uint32_t count[2];     // Bytes absorbed.  A whole last block stays in buffer until Final
+} BLAKE2S_CTX;
+
+#define BLAKE2S_MATCH(X,Y) (memcmp((X),(Y),BLAKE2S_RESULT_BYTES))
+
+void BLAKE2sInit(BLAKE2S_CTX *);
+uint8_t BLAKE2sInitKey(BLAKE2S_CTX *,char * key,uint8_t length);
+void BLAKE2sUpdate(BLAKE2S_CTX *,char * data,uint16_t length);
+void BLAKE2sFinal(BLAKE2S_CTX *);
+
+#endif
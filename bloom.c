@@ -0,0 +1,202 @@
+/* Blocked Bloom filter on digests : cheap pre-filter of large key sets
+
+   A key is hashed once, with any algorithm here, and its digest supplies
+   everything : the first word picks one 64 byte block (a cache line) and the next
+   two, h1 and h2, give the k bit positions within it by enhanced double hashing
+   (h1+i*h2+(i^3-i)/6, Dillinger and Manolios).  So a test costs one digest and one
+   cache miss, however large k.  Confining a key to a block raises the false
+   positive rate over a plain Bloom filter of the same size, more so at low rates :
+   e.g. 1.0% rather than 0.8% at 10 bits a key, 0.12% rather than 0.05% at 16.
+
+   For a false positive rate p, use c. -1.44*log2(p) bits per key and k=0.69 times
+   that, e.g. 10 bits and k=7 for 1%.  BloomFalsePositivePpm() estimates the actual
+   rate from how full the blocks are.
+
+   Batches of digests (e.g. the output of HashBatch(), stride HASH_BATCH_STRIDE)
+   are added or tested 16 at a time : every block is located and prefetched first,
+   so the misses overlap.
+
+   The filter lives in one image : a 64 byte header (magic, block count, k and
+   algorithm, littleendian) and then the blocks.  Bits are addressed by byte, so the
+   image is the same on any host and can be written out as it stands, then mapped
+   (or read) back and used in place via BloomAttach().
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "bloom.h"
+#include "batch.h"
+#include <math.h>   // pow
+#include <string.h> // memset
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define BATCH       (16)   // Digests located ahead of being probed
+#define BLOCK_BITS  (BLOOM_BLOCK_BYTES*8)
+#define POSITION(H) ((H)&(BLOCK_BITS-1))  // Bit within a block
+
+static char * Locate(BLOOM_FILTER * filter,char * digest);
+static void Set(BLOOM_FILTER * filter,char * block,char * digest);
+static uint8_t Probe(BLOOM_FILTER * filter,char * block,char * digest);
+static uint32_t Get32(char * input);
+static void Put32(char * output,uint32_t x);
+
+// --------------------------------------------------------------------------------
+uint32_t BloomBlocks(uint32_t keys,uint16_t bitsPerKey)
+{ // Blocks for keys keys at bitsPerKey bits each
+uint64_t n=((uint64_t)keys*bitsPerKey+BLOCK_BITS-1)/BLOCK_BITS;
+return (n==0)?1:(n>BLOOM_MAX_BLOCKS)?BLOOM_MAX_BLOCKS:n;
+}
+// --------------------------------------------------------------------------------
+uint32_t BloomBytes(uint32_t blocks)
+{ // Size of the image, or 0 if blocks is over BLOOM_MAX_BLOCKS
+if (blocks>BLOOM_MAX_BLOCKS) return 0;
+return BLOOM_HEADER_BYTES+(uint64_t)blocks*BLOOM_BLOCK_BYTES;
+}
+// --------------------------------------------------------------------------------
+uint8_t BloomInit(BLOOM_FILTER * filter,char * image,uint32_t blocks,uint8_t k,uint8_t alg)
+{ // Empty filter in image (BloomBytes(blocks) chars, ideally 64 byte aligned).
+  // k<=BLOOM_MAX_K, and alg must give digests of BLOOM_MIN_DIGEST or more bytes.
+  // Returns BloomAttach()'s 1, or 0 if any of those is out of range.
+memset(image,0,BloomBytes(blocks));
+memcpy(image,BLOOM_MAGIC,sizeof(BLOOM_MAGIC));
+Put32(&image[8],blocks);
+image[12]=k;
+image[13]=alg;
+return BloomAttach(filter,image,BloomBytes(blocks));
+}
+// --------------------------------------------------------------------------------
+uint8_t BloomAttach(BLOOM_FILTER * filter,char * image,uint32_t bytes)
+{ // Uses an image made by BloomInit(), e.g. mapped from a file.  Returns 1, or 0 if
+  // it is not a filter image, bytes is not its size or its algorithm's digests are
+  // too short (or it is unknown).
+if (bytes<BLOOM_HEADER_BYTES || memcmp(image,BLOOM_MAGIC,sizeof(BLOOM_MAGIC)) ||
+    Get32(&image[8])==0 || BloomBytes(Get32(&image[8]))!=bytes ||  // 0 if too many blocks
+    image[12]==0 || (uint8_t)image[12]>BLOOM_MAX_K ||
+    HashDigestBytes(image[13])<BLOOM_MIN_DIGEST) return 0;
+
+filter->image=image;
+filter->block=&image[BLOOM_HEADER_BYTES];
+filter->blocks=Get32(&image[8]);
+filter->k=image[12];
+filter->alg=image[13];
+return 1;
+}
+// --------------------------------------------------------------------------------
+void BloomAddDigest(BLOOM_FILTER * filter,char * digest)
+{
+Set(filter,Locate(filter,digest),digest);
+}
+// --------------------------------------------------------------------------------
+uint8_t BloomTestDigest(BLOOM_FILTER * filter,char * digest)
+{ // 1 if digest may have been added, 0 if it certainly was not
+return Probe(filter,Locate(filter,digest),digest);
+}
+// --------------------------------------------------------------------------------
+void BloomAddBatch(BLOOM_FILTER * filter,char * digests,uint32_t n,uint8_t stride)
+{ // Adds n digests, stride chars apart
+char * block[BATCH];
+
+for (uint32_t i=0;i<n;i+=BATCH,digests+=BATCH*stride) {
+  uint8_t m=(n-i<BATCH)?n-i:BATCH;
+
+  for (uint8_t j=0;j<m;j++) {
+    block[j]=Locate(filter,&digests[j*stride]);
+    __builtin_prefetch(block[j],1);
+  }
+  for (uint8_t j=0;j<m;j++) Set(filter,block[j],&digests[j*stride]);
+}
+}
+// --------------------------------------------------------------------------------
+void BloomTestBatch(BLOOM_FILTER * filter,char * digests,uint32_t n,uint8_t stride,uint8_t * result)
+{ // result[i] is BloomTestDigest() of the i'th of n digests, stride chars apart
+char * block[BATCH];
+
+for (uint32_t i=0;i<n;i+=BATCH,digests+=BATCH*stride) {
+  uint8_t m=(n-i<BATCH)?n-i:BATCH;
+
+  for (uint8_t j=0;j<m;j++) {
+    block[j]=Locate(filter,&digests[j*stride]);
+    __builtin_prefetch(block[j]);
+  }
+  for (uint8_t j=0;j<m;j++) result[i+j]=Probe(filter,block[j],&digests[j*stride]);
+}
+}
+// --------------------------------------------------------------------------------
+void BloomAdd(BLOOM_FILTER * filter,char * data,uint32_t length)
+{ // Hashes data with the filter's algorithm and adds it
+HashOne(filter->alg,data,length);
+BloomAddDigest(filter,buffer);
+}
+// --------------------------------------------------------------------------------
+uint8_t BloomTest(BLOOM_FILTER * filter,char * data,uint32_t length)
+{
+HashOne(filter->alg,data,length);
+return BloomTestDigest(filter,buffer);
+}
+// --------------------------------------------------------------------------------
+uint32_t BloomFalsePositivePpm(BLOOM_FILTER * filter)
+{ // Expected false positives per million tests of absent keys : the mean over blocks
+  // of (fraction of bits set)^k.  Reads the whole filter.
+double p=0;
+
+for (uint32_t b=0;b<filter->blocks;b++) {
+  uint16_t set=0;
+
+  for (uint8_t i=0;i<BLOOM_BLOCK_BYTES;i++) 
+    set+=__builtin_popcount((uint8_t)filter->block[b*BLOOM_BLOCK_BYTES+i]);
+  p+=pow((double)set/BLOCK_BITS,filter->k);
+}
+return p*1e6/filter->blocks+0.5;
+}
+// --------------------------------------------------------------------------------
+static char * Locate(BLOOM_FILTER * filter,char * digest)
+{ // Block for digest : its first word scaled to [0,blocks)
+return &filter->block[(uint32_t)(((uint64_t)Get32(digest)*filter->blocks)>>32)*BLOOM_BLOCK_BYTES];
+}
+// --------------------------------------------------------------------------------
+static void Set(BLOOM_FILTER * filter,char * block,char * digest)
+{
+uint32_t h=Get32(&digest[4]);
+uint32_t d=Get32(&digest[8])|1;  // Never 0, so the first two probes differ
+
+for (uint8_t i=0;i<filter->k;i++,h+=d,d+=i) block[POSITION(h)>>3]|=1<<(POSITION(h)&7);
+}
+// --------------------------------------------------------------------------------
+static uint8_t Probe(BLOOM_FILTER * filter,char * block,char * digest)
+{
+uint32_t h=Get32(&digest[4]);
+uint32_t d=Get32(&digest[8])|1;
+
+for (uint8_t i=0;i<filter->k;i++,h+=d,d+=i) 
+  if ((block[POSITION(h)>>3]&(1<<(POSITION(h)&7)))==0) return 0;
+return 1;
+}
+// --------------------------------------------------------------------------------
+static uint32_t Get32(char * input)
+{
+return ((uint32_t)(uint8_t)input[3]<<24)|((uint32_t)(uint8_t)input[2]<<16)|
+       ((uint32_t)(uint8_t)input[1]<<8) | (uint8_t)input[0];
+}
+// --------------------------------------------------------------------------------
+static void Put32(char * output,uint32_t x)
+{
+output[0]=x;
+output[1]=x>>8;
+output[2]=x>>16;
+output[3]=x>>24;
+}
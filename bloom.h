@@ -0,0 +1,37 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stdint.h>
+#include "hash.h"
+
+// Blocked Bloom filter : every probe of a key falls in one 64 byte block, and all
+// of them come from the key's one digest.  See bloom.c
+
+#define BLOOM_MAGIC         "HASHBF1"
+#define BLOOM_HEADER_BYTES  (64)   // Image header, keeps the blocks cache line aligned
+#define BLOOM_BLOCK_BYTES   (64)
+#define BLOOM_MAX_K         (16)
+#define BLOOM_MIN_DIGEST    (12)   // Digest bytes used : block, then two probe words
+#define BLOOM_MAX_BLOCKS    ((0xFFFFFFFFUL-BLOOM_HEADER_BYTES)/BLOOM_BLOCK_BYTES)  // Image size fits 32 bits
+
+typedef struct {
+  char *   image;        // Caller storage, BloomBytes(blocks) chars : header then blocks
+  char *   block;        // &image[BLOOM_HEADER_BYTES]
+  uint32_t blocks;
+  uint8_t  k;            // Probes per key
+  uint8_t  alg;          // HASH_ID_xxx of the digests, for BloomAdd()/BloomTest()
+} BLOOM_FILTER;
+
+uint32_t BloomBlocks(uint32_t keys,uint16_t bitsPerKey);
+uint32_t BloomBytes(uint32_t blocks);
+uint8_t  BloomInit(BLOOM_FILTER *,char * image,uint32_t blocks,uint8_t k,uint8_t alg);
+uint8_t  BloomAttach(BLOOM_FILTER *,char * image,uint32_t bytes);
+void     BloomAddDigest(BLOOM_FILTER *,char * digest);
+uint8_t  BloomTestDigest(BLOOM_FILTER *,char * digest);
+void     BloomAddBatch(BLOOM_FILTER *,char * digests,uint32_t n,uint8_t stride);
+void     BloomTestBatch(BLOOM_FILTER *,char * digests,uint32_t n,uint8_t stride,uint8_t * result);
+void     BloomAdd(BLOOM_FILTER *,char * data,uint32_t length);
+uint8_t  BloomTest(BLOOM_FILTER *,char * data,uint32_t length);
+uint32_t BloomFalsePositivePpm(BLOOM_FILTER *);
+
+#endif
@@ -0,0 +1,229 @@
+/* Content defined chunking (gear rolling hash) fused with SHA-256
+
+   Each chunk boundary depends only on the preceding CDC_WINDOW bytes, so inserting
+   or deleting data only moves the boundaries near the edit, which is what makes
+   chunk digests useful for deduplication.  The rolling hash is
+   gear=(gear<<1)+Gear[byte] and a boundary is declared when its top CDC_AVG_BITS
+   are all zero, subject to the CDC_MIN_BYTES / CDC_MAX_BYTES limits.  Rolling is
+   skipped entirely for the first CDC_MIN_BYTES-CDC_WINDOW bytes of a chunk.
+
+   Input is scanned and passed to SHA256Update() at most one block at a time, so the
+   bytes examined for a boundary are hashed while still in cache.
+
+   Use :
+
+     CDCInit(&cdc);
+     while (length) {
+       uint16_t n=CDCUpdate(&cdc,data,length);
+       data+=n; length-=n;
+       if (cdc.ready) ... // Chunk of cdc.size bytes, digest in buffer.  Use it now.
+     }
+     if (CDCFinal(&cdc)) ... // Last chunk, as above
+
+   A large input held in memory can instead be chunked and hashed on the pool
+   (HASH_THREADS in config.h) by CDCChunkAll().  The input is cut into segments of
+   CDC_SEGMENT_BYTES, and each segment is chunked as though a chunk began at its
+   start, running on past its end to finish its last chunk.  A boundary depends only
+   on where its chunk began, so once the real sequence of boundaries arriving from
+   the previous segment meets a chunk start found in this one, the two agree from
+   there on.  A serial pass stitches the segments together, rechunking only from
+   each seam to the first such meeting point, normally within a chunk or two.
+
+     n=CDCChunkAll(data,length,chunks,scratch,0);  // Both arrays CDCSlots(length) long
+     for (uint32_t i=0;i<n;i++) DedupInsert(&index,chunks[i].digest,chunks[i].size);
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "cdc.h"
+#include "pool.h"
+#include <string.h> // memset, memcpy
+
+extern HASH_TLS char buffer[MSG_LENGTH];
+
+typedef struct {
+  char *      data;
+  uint32_t    length;
+  CDC_CHUNK * scratch;
+} SEGMENTING;
+
+static void     SegmentChunk(void * arg,uint32_t first,uint32_t last);
+static uint32_t NextChunk(char * data,uint32_t length,CDC_CHUNK * chunk);
+
+static const uint32_t Gear[256] ROM={  // First 4 bytes (bigendian) of SHA-256 of each byte value
+  0x6e340b9c,0x4bf5122f,0xdbc1b4c9,0x084fed08,0xe52d9c50,0xe77b9a9a,0x67586e98,0xca358758,
+  0xbeead779,0x2b4c342f,0x01ba4719,0xe7cf46a0,0xef6cbd21,0x9d1e0e2d,0x4d7b3ef7,0xdc0e9c36,
+  0xc555eab4,0x4a64a107,0xf299791c,0xab897fbd,0x83891d7f,0x2f0fd1e8,0x7cb7c454,0x8f11b05d,
+  0x452ba1dd,0x68aa2e2e,0x58f7b078,0x77adfc95,0xbd4fc42a,0x1f18d650,0x9652595f,0xffe679bb,
+  0x36a9e7f1,0xbb7208bc,0x8a331fdd,0x334359b9,0x09fc9608,0xbbf3f11c,0x951dcee3,0x265fda17,
+  0x32ebb1ab,0xba5ec51d,0x684888c0,0xa318c242,0xd03502c4,0x3973e022,0xcdb4ee2a,0x8a5edab2,
+  0x5feceb66,0x6b86b273,0xd4735e3a,0x4e074085,0x4b227777,0xef2d127d,0xe7f6c011,0x7902699b,
+  0x2c624232,0x19581e27,0xe7ac0786,0x41b805ea,0xdabd3aff,0x380918b9,0x62b67e1f,0x8a8de823,
+  0xc3641f85,0x559aead0,0xdf7e70e5,0x6b23c0d5,0x3f39d5c3,0xa9f51566,0xf67ab10a,0x333e0a1e,
+  0x44bd7ae6,0xa83dd0cc,0x6da43b94,0x86be9a55,0x72dfcfb0,0x08f27188,0x8ce86a6a,0xc4694f2e,
+  0x5c62e091,0x4ae81572,0x8c257489,0x8de0b3c4,0xe632b709,0xa25513c7,0xde5a6f78,0xfcb5f40d,
+  0x4b68ab38,0x18f5384d,0xbbeebd87,0x245843ab,0xa9253dc8,0xcfae0d42,0x74cd9ef9,0xd2e2adf7,
+  0x8d33f520,0xca978112,0x3e23e816,0x2e7d2c03,0x18ac3e73,0x3f79bb7b,0x252f10c8,0xcd0aa985,
+  0xaaa94026,0xde7d1b72,0x189f4003,0x8254c329,0xacac86c0,0x62c66a7a,0x1b16b1df,0x65c74c15,
+  0x148de9c5,0x8e35c2cd,0x454349e4,0x043a7187,0xe3b98a4d,0x0bfe935e,0x4c94485e,0x50e721e4,
+  0x2d711642,0xa1fce436,0x594e519a,0x021fb596,0xcbe5cfdf,0xd10b36aa,0x7ace431c,0x620bfdaa,
+  0x76be8b52,0x591b7cc9,0xa5ab782c,0x5ee0dd4d,0xaaa8e61e,0xc00e7f88,0x3cbdaf66,0x4bfa260a,
+  0x4f362f90,0xe9b0c031,0x2d319369,0x3ebe1b59,0x9defb0a9,0x075198bf,0x949f94d8,0x5e37305c,
+  0x9e076cea,0x7da59d0d,0x95606213,0xd16bd22f,0x67c872d4,0x5bad0d11,0x84873854,0x2a0ab732,
+  0x79bec7ff,0xfd9528b9,0x0605d153,0x8d36bbb3,0x6e3faf1e,0x9d277175,0x35af2d15,0x1f184f10,
+  0xc19a797f,0x8a8950f7,0x0a43b22d,0x6d90fbac,0x88aa3e3b,0x6922e93e,0xfe1dcd3a,0x2dbf9365,
+  0x74e1ade3,0x9e8e8c37,0xbceef655,0x087d80f7,0xee6bb86b,0x22adaf05,0x19753a9b,0x5a6e7a47,
+  0xf4f97c88,0x149488d8,0x9be3799f,0x65f15821,0x27952171,0x892f60b3,0xca41841c,0x4d6a8e90,
+  0xd3bb0d59,0x04d6c0c9,0x281c9399,0xcbecda1c,0x26e5bfe4,0x68325720,0x47850848,0xb12dc850,
+  0xe4ff5e7d,0xd1bbd73b,0xc557e713,0xae3f4619,0xd1211001,0x5a0ec31d,0x49994461,0x3340883a,
+  0x7c5bd2d1,0x4fb733be,0x13598656,0x383e5d7d,0x1dd83126,0x9a7b7b3a,0xc337ded6,0x7a4a4b50,
+  0xd4b0c0a4,0xb5c9a5f4,0x85f97e04,0x28969cdf,0x528a84ce,0xcdce9374,0x0a2c6ea0,0x414a21e5,
+  0xaf193a8c,0x19152ddf,0x5d5c7d20,0xb7d25296,0xfb95aa98,0x2795044c,0x7941cb07,0x2ea970ff,
+  0x7d8c5da7,0xf031efa5,0x30a5bfa5,0x457e4854,0x5e1effe9,0xab61ba11,0x0a3aaee7,0xd0752b60,
+  0xe6f20750,0xde2e331d,0x3ad4e44a,0xf8d20e59,0x45f83d17,0xf3df1f9c,0x94455e3e,0x4d4d75d7,
+  0xfde50285,0xd4f09e5c,0x966c7c47,0x782e0202,0x2017ff34,0x27abdedd,0xb0b2988b,0x50868f20,
+  0xe596a8e5,0xd5202253,0xaa7225e7,0x04b8d34e,0x98722e2e,0x3e151409,0xaa687b58,0xa8100ae6};
+
+// --------------------------------------------------------------------------------
+void CDCInit(CDC_CTX * context)
+{
+SHA256Init(&context->sha);
+context->gear=context->length=context->size=0;
+context->ready=0;
+}
+// --------------------------------------------------------------------------------
+uint16_t CDCUpdate(CDC_CTX * context,char * input,uint16_t inputLen)
+{ // Scans and hashes input up to and including the next chunk boundary.  Returns
+  // the number of chars consumed.  If a boundary was found, ready is set and the
+  // chunk's digest is in buffer, where the next call will overwrite it.
+uint16_t i=0;
+
+context->ready=0;
+while (i<inputLen) {
+  uint16_t run=SHA256_INPUT_BYTES-(((uint8_t)context->sha.count[SHA256_LSW])&0x3F);
+  uint16_t j=0;
+  uint8_t  cut=0;
+
+  if (run>inputLen-i) run=inputLen-i;   // Now no further than end of block or input
+
+  if (context->length<CDC_MIN_BYTES-CDC_WINDOW) {  // Too early to influence a boundary
+    uint32_t skip=CDC_MIN_BYTES-CDC_WINDOW-context->length;
+    j=(skip<run)?skip:run;
+  }
+  while (j<run && !cut) {
+    context->gear=(context->gear<<1)+ROM_WORD32(Gear[(uint8_t)input[i+j++]]);
+    uint32_t len=context->length+j;
+    cut=(len>=CDC_MIN_BYTES && ((context->gear>>(32-CDC_AVG_BITS))==0 || len>=CDC_MAX_BYTES));
+  }
+  SHA256Update(&context->sha,&input[i],j);
+  context->length+=j;
+  i+=j;
+
+  if (cut) {
+    SHA256Final(&context->sha);  // Digest into buffer
+    SHA256Init(&context->sha);   // Leaves buffer alone
+    context->size=context->length;
+    context->length=context->gear=0;
+    context->ready=1;
+    break;
+  }
+}
+return i;
+}
+// --------------------------------------------------------------------------------
+uint8_t CDCFinal(CDC_CTX * context)
+{ // Closes the trailing chunk.  Returns 1 if there was one (digest in buffer, size
+  // set), 0 if the input ended exactly on a boundary.
+context->ready=0;
+if (context->length==0) {
+  memset(context,0,sizeof(*context));
+  return 0;
+}
+SHA256Final(&context->sha);
+context->size=context->length;
+context->length=context->gear=0;
+context->ready=1;
+return 1;
+}
+// --------------------------------------------------------------------------------
+uint32_t CDCSlots(uint32_t length)
+{ // CDC_CHUNKs needed by CDCChunkAll() for each of chunks and scratch
+return (uint32_t)(((uint64_t)length+CDC_SEGMENT_BYTES-1)/CDC_SEGMENT_BYTES)*CDC_SEGMENT_CHUNKS;
+}
+// --------------------------------------------------------------------------------
+uint32_t CDCChunkAll(char * data,uint32_t length,CDC_CHUNK * chunks,CDC_CHUNK * scratch,uint8_t threads)
+{ // Chunks and hashes all of data, exactly as CDCUpdate()/CDCFinal() would, into
+  // chunks.  Returns the number of chunks.  threads 0 means PoolThreads().
+uint32_t bounds[POOL_MAX_CHUNKS+1];
+uint32_t segments=(uint32_t)(((uint64_t)length+CDC_SEGMENT_BYTES-1)/CDC_SEGMENT_BYTES);
+uint32_t n=0,pos=0;
+SEGMENTING segmenting={data,length,scratch};
+
+if (threads==0) threads=PoolThreads();
+PoolRun(SegmentChunk,&segmenting,bounds,PoolSplit(bounds,segments,threads),threads);
+
+for (uint32_t k=0;k<segments;k++) {  // Stitch : keep the first chunk start shared with the real sequence, and all after it
+  CDC_CHUNK * c=&scratch[k*CDC_SEGMENT_CHUNKS];
+  uint32_t end=(length-k*CDC_SEGMENT_BYTES>CDC_SEGMENT_BYTES)?(k+1)*CDC_SEGMENT_BYTES:length;
+  uint32_t i=0;
+
+  while (pos<end) {
+    while (i<CDC_SEGMENT_CHUNKS && c[i].size && c[i].offset<pos) i++;
+    if (i<CDC_SEGMENT_CHUNKS && c[i].size && c[i].offset==pos)
+      chunks[n]=c[i];
+    else
+      NextChunk(&data[pos],length-pos,&chunks[n]);
+    chunks[n].offset=pos;
+    pos+=chunks[n++].size;
+  }
+}
+return n;
+}
+// --------------------------------------------------------------------------------
+static void SegmentChunk(void * arg,uint32_t first,uint32_t last)
+{ // Segments first..last-1 into their scratch areas, each ended by a size of 0 if short
+SEGMENTING * s=(SEGMENTING *)arg;
+
+for (uint32_t k=first;k<last;k++) {
+  CDC_CHUNK * c=&s->scratch[k*CDC_SEGMENT_CHUNKS];
+  uint32_t pos=k*CDC_SEGMENT_BYTES;
+  uint32_t end=(s->length-pos>CDC_SEGMENT_BYTES)?pos+CDC_SEGMENT_BYTES:s->length;
+  uint32_t i=0;
+
+  while (pos<end) {  // At most CDC_SEGMENT_CHUNKS, as all but the input's last are >= CDC_MIN_BYTES
+    c[i].offset=pos;
+    pos+=NextChunk(&s->data[pos],s->length-pos,&c[i]);
+    i++;
+  }
+  if (i<CDC_SEGMENT_CHUNKS) c[i].size=0;
+}
+}
+// --------------------------------------------------------------------------------
+static uint32_t NextChunk(char * data,uint32_t length,CDC_CHUNK * chunk)
+{ // Chunks and hashes from a boundary at data (length>0) to the next, or the end.
+  // Sets chunk's size and digest, and returns the size.
+CDC_CTX cdc;
+uint32_t size=0;
+
+CDCInit(&cdc);
+while (size<length && !cdc.ready)
+  size+=CDCUpdate(&cdc,&data[size],(length-size>0xFFFF)?0xFFFF:length-size);
+if (!cdc.ready) CDCFinal(&cdc);
+memcpy(chunk->digest,buffer,SHA256_RESULT_BYTES);
+chunk->size=size;
+return size;
+}
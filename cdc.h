@@ -0,0 +1,52 @@
+#ifndef CDC_H
+#define CDC_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "sha256.h"
+
+// Content defined chunking, with each chunk hashed by SHA-256 as it is found.
+// Sizes may be overridden in config.h
+
+#ifndef CDC_MIN_BYTES
+#define CDC_MIN_BYTES    (2048)  // No boundary before this many bytes
+#endif
+#ifndef CDC_AVG_BITS
+#define CDC_AVG_BITS       (13)  // Boundary chance 1 in 2^CDC_AVG_BITS per byte after minimum
+#endif
+#ifndef CDC_MAX_BYTES
+#define CDC_MAX_BYTES   (65536)  // Boundary forced at this size
+#endif
+
+#ifndef CDC_SEGMENT_BYTES
+#define CDC_SEGMENT_BYTES (1UL<<20)  // CDCChunkAll() : input per pool item, a multiple of CDC_MIN_BYTES
+#endif
+
+#define CDC_WINDOW         (32)  // Bytes that influence the top bit of the gear hash
+#define CDC_SEGMENT_CHUNKS (CDC_SEGMENT_BYTES/CDC_MIN_BYTES)  // Most chunks starting in a segment
+
+#if CDC_SEGMENT_BYTES%CDC_MIN_BYTES
+#error "CDC_SEGMENT_BYTES must be a multiple of CDC_MIN_BYTES"
+#endif
+
+typedef struct {
+  SHA256_CTX sha;
+  uint32_t gear;      // Rolling hash
+  uint32_t length;    // Bytes so far in the current chunk
+  uint32_t size;      // Size of the chunk just completed, valid when ready
+  uint8_t  ready;     // Chunk completed by last call, its digest is in buffer
+} CDC_CTX;
+
+typedef struct {
+  uint32_t offset;    // In the input
+  uint32_t size;
+  char     digest[SHA256_RESULT_BYTES];
+} CDC_CHUNK;
+
+void     CDCInit(CDC_CTX *);
+uint16_t CDCUpdate(CDC_CTX *,char * data,uint16_t length);
+uint8_t  CDCFinal(CDC_CTX *);
+uint32_t CDCSlots(uint32_t length);
+uint32_t CDCChunkAll(char * data,uint32_t length,CDC_CHUNK * chunks,CDC_CHUNK * scratch,uint8_t threads);
+
+#endif
@@ -0,0 +1,174 @@
+/* Hash chains for one time passwords (S/KEY style), forwards and in reverse
+
+   x[0] is the secret seed (a digest), x[i+1]=H(x[i]).  The verifier holds x[n] and
+   the passwords are x[n-1], x[n-2] ... x[0], i.e. the chain in reverse, each checked
+   by hashing it once to get the previous one.
+
+   Going forwards, each step is XXXIterate() : one Transform on a block built
+   straight from the previous digest's words, never converted to bytes in between.
+
+   Going backwards, recomputing each element from the seed would cost i hashes for
+   x[i].  Instead ChainNext() keeps a stack of pebbles (stored elements).  To reach
+   the next element it repeatedly puts a pebble halfway between the top pebble and
+   the target, so with ChainPebbles(n) pebbles, about log2(n), every element costs
+   O(log n) hashes amortised (about log2(n)/2 in practice).  With fewer pebbles
+   the last stretch is hashed through without storing, trading time for memory :
+   one pebble (just the seed) costs n/2 hashes per element, and each extra pebble
+   divides that by about 3 until the log2(n) level is reached.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "chain.h"
+#include "md5.h"
+#include "sha1.h"
+#include "sha256.h"
+#include <string.h> // memcpy
+
+static uint8_t Words(uint8_t alg);
+static void Iterate(uint8_t alg,JOINED * word,uint32_t n);
+static void FromBytes(uint8_t alg,JOINED * word,char * input);
+static void ToBytes(uint8_t alg,char * output,JOINED * word);
+
+// --------------------------------------------------------------------------------
+uint8_t ChainPebbles(uint32_t n)
+{ // Pebbles for O(log n) hashes per element over a chain of n
+uint8_t k=1;
+
+while (n>1) {
+  n=(n+1)/2;
+  k++;
+}
+return k;
+}
+// --------------------------------------------------------------------------------
+void ChainElement(uint8_t alg,char * seed,uint32_t i,char * output)
+{ // x[i] directly, in i hashes.  x[n] is what the verifier stores.
+JOINED word[8];
+
+FromBytes(alg,word,seed);
+Iterate(alg,word,i);
+ToBytes(alg,output,word);
+memset(word,0,sizeof(word));
+}
+// --------------------------------------------------------------------------------
+uint8_t ChainInit(HASH_CHAIN * chain,uint8_t alg,char * seed,uint32_t n,HASH_PEBBLE * pebble,uint8_t pebbles)
+{ // Prepares to emit x[n-1] down to x[0].  Returns 0 if alg is not supported or there
+  // is no pebble.
+if (Words(alg)==0 || pebbles==0) return 0;
+
+chain->pebble=pebble;
+chain->pebbles=pebbles;
+chain->alg=alg;
+chain->hashes=0;
+chain->next=n-1;
+chain->top=(n>0);
+pebble[0].position=0;
+FromBytes(alg,pebble[0].word,seed);
+return 1;
+}
+// --------------------------------------------------------------------------------
+uint8_t ChainNext(HASH_CHAIN * chain,char * output)
+{ // Next element going backwards, into output.  Returns 0 once x[0] has been emitted.
+HASH_PEBBLE * top;
+uint32_t target=chain->next;
+
+if (chain->top==0) return 0;
+top=&chain->pebble[chain->top-1];
+
+while (top->position!=target) {
+  uint32_t gap=target-top->position;
+
+  if (chain->top==chain->pebbles) {   // Out of pebbles : straight through to target
+    JOINED word[8];
+
+    memcpy(word,top->word,sizeof(word));
+    Iterate(chain->alg,word,gap);
+    chain->hashes+=gap;
+    ToBytes(chain->alg,output,word);
+    memset(word,0,sizeof(word));
+    chain->next--;
+    return 1;
+  }
+  uint32_t step=(gap+1)/2;            // New pebble halfway, rounding up
+  
+  memcpy(top[1].word,top->word,sizeof(top->word));
+  top[1].position=top->position+step;
+  top++;
+  chain->top++;
+  Iterate(chain->alg,top->word,step);
+  chain->hashes+=step;
+}
+ToBytes(chain->alg,output,top->word);
+memset(top,0,sizeof(*top));          // No longer needed, as targets only go down
+chain->top--;
+chain->next--;
+return 1;
+}
+// --------------------------------------------------------------------------------
+static uint8_t Words(uint8_t alg)
+{
+switch (alg) {
+  case HASH_ID_MD5:    return MD5_RESULT_BYTES/4;
+  case HASH_ID_SHA1:   return SHA1_RESULT_BYTES/4;
+  case HASH_ID_SHA256: return SHA256_RESULT_BYTES/4;
+}
+return 0;
+}
+// --------------------------------------------------------------------------------
+static void Iterate(uint8_t alg,JOINED * word,uint32_t n)
+{
+switch (alg) {
+  case HASH_ID_MD5:    MD5Iterate(word,n);    break;
+  case HASH_ID_SHA1:   SHA1Iterate(word,n);   break;
+  case HASH_ID_SHA256: SHA256Iterate(word,n); break;
+}
+}
+// --------------------------------------------------------------------------------
+static void FromBytes(uint8_t alg,JOINED * word,char * input)
+{ // Digest bytes to native words : MD5 is littleendian, the SHAs bigendian
+for (uint8_t i=0,j=0;i<Words(alg);i++,j+=4) {
+  if (alg==HASH_ID_MD5) {
+    word[i].lsb =input[j];
+    word[i].slsb=input[j+1];
+    word[i].smsb=input[j+2];
+    word[i].msb =input[j+3];
+  } else {
+    word[i].msb =input[j];
+    word[i].smsb=input[j+1];
+    word[i].slsb=input[j+2];
+    word[i].lsb =input[j+3];
+  }
+}
+}
+// --------------------------------------------------------------------------------
+static void ToBytes(uint8_t alg,char * output,JOINED * word)
+{
+for (uint8_t i=0,j=0;i<Words(alg);i++,j+=4) {
+  if (alg==HASH_ID_MD5) {
+    output[j]  =word[i].lsb;
+    output[j+1]=word[i].slsb;
+    output[j+2]=word[i].smsb;
+    output[j+3]=word[i].msb;
+  } else {
+    output[j]  =word[i].msb;
+    output[j+1]=word[i].smsb;
+    output[j+2]=word[i].slsb;
+    output[j+3]=word[i].lsb;
+  }
+}
+}
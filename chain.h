@@ -0,0 +1,29 @@
+#ifndef CHAIN_H
+#define CHAIN_H
+
+#include <stdint.h>
+#include "hash.h"
+
+// Hash chains x[i+1]=H(x[i]) (S/KEY style one time passwords) with H any of MD5, SHA1
+// or SHA256, and their traversal in reverse order from a few stored pebbles.
+
+typedef struct {
+  uint32_t position;     // i, for x[i]
+  JOINED   word[8];      // x[i] in native words, up to SHA256_RESULT_BYTES
+} HASH_PEBBLE;
+
+typedef struct {
+  HASH_PEBBLE * pebble;  // Caller storage, used as a stack, x[0] at the bottom
+  uint32_t hashes;       // Hashes computed so far, for tuning
+  uint32_t next;         // Element ChainNext() emits next
+  uint8_t  pebbles;      // Capacity of pebble
+  uint8_t  top;          // Pebbles in use
+  uint8_t  alg;          // HASH_ID_MD5, HASH_ID_SHA1 or HASH_ID_SHA256
+} HASH_CHAIN;
+
+uint8_t ChainPebbles(uint32_t n);
+void    ChainElement(uint8_t alg,char * seed,uint32_t i,char * output);
+uint8_t ChainInit(HASH_CHAIN *,uint8_t alg,char * seed,uint32_t n,HASH_PEBBLE * pebble,uint8_t pebbles);
+uint8_t ChainNext(HASH_CHAIN *,char * output);
+
+#endif
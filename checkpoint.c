@@ -0,0 +1,103 @@
+/* Checkpoint and resume of in-progress hashes
+
+   Captures everything an algorithm needs to carry on : chaining words, byte count
+   and the partial block waiting in the shared buffer.  Format is independent of
+   the machine's endianness, so a checkpoint written on the host can be resumed on
+   the microcontroller and vice versa.  Used through the per-algorithm macros
+   (MD5Save(), MD5Restore() etc.) rather than directly.
+
+   Saving does not disturb the context, so a typical growing-file sequence is :
+
+     XXXUpdate() ... ; XXXSave(&ctx,store); XXXFinal(&ctx);   // Digest now, keep store
+
+   and later, once more data has been appended :
+
+     XXXRestore(&ctx,store);
+     // Skip the first HashCheckpointBytes(store) bytes of the source, then
+     XXXUpdate() ... ; XXXSave(&ctx,store); XXXFinal(&ctx);
+
+   so only the appended bytes are ever hashed again.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "checkpoint.h"
+#include <string.h> // memcpy
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define CHECKPOINT_BUF_OFFSET  (4)  // Same for every algorithm's *_BUF_OFFSET
+
+static void Put32(char * output,uint32_t x);
+static uint32_t Get32(char * input);
+
+// --------------------------------------------------------------------------------
+uint8_t HashCheckpointSave(char * output,uint8_t id,JOINED * state,uint8_t stateBytes,
+                           uint32_t * count,uint8_t lsw)
+{ // Writes the checkpoint to output (up to HASH_CHECKPOINT_MAX chars) and returns its length.
+  // Must be called between Updates : the pending partial block is read from buffer.
+uint8_t index=(((uint8_t)count[lsw])&0x3F);
+uint8_t j=HASH_CHECKPOINT_HEADER;
+
+output[0]=HASH_CHECKPOINT_VERSION;
+output[1]=id;
+Put32(&output[2],count[lsw]);
+Put32(&output[6],count[1-lsw]);
+
+for (uint8_t i=0;i<stateBytes/4;i++,j+=4) Put32(&output[j],state[i].word32);
+
+memcpy(&output[j],&buffer[CHECKPOINT_BUF_OFFSET],index);
+return j+index;
+}
+// --------------------------------------------------------------------------------
+uint8_t HashCheckpointRestore(char * input,uint8_t id,JOINED * state,uint8_t stateBytes,
+                              uint32_t * count,uint8_t lsw)
+{ // Reinstates a checkpoint made by HashCheckpointSave(), including its partial block
+  // in buffer.  Returns length consumed, or 0 (context untouched) if the checkpoint is
+  // from another version or algorithm.
+uint8_t j=HASH_CHECKPOINT_HEADER;
+
+if (input[0]!=HASH_CHECKPOINT_VERSION || input[1]!=id) return 0;
+
+count[lsw]  =Get32(&input[2]);
+count[1-lsw]=Get32(&input[6]);
+
+for (uint8_t i=0;i<stateBytes/4;i++,j+=4) state[i].word32=Get32(&input[j]);
+
+uint8_t index=(((uint8_t)count[lsw])&0x3F);
+memcpy(&buffer[CHECKPOINT_BUF_OFFSET],&input[j],index);
+return j+index;
+}
+// --------------------------------------------------------------------------------
+uint64_t HashCheckpointBytes(char * input)
+{ // Bytes already absorbed when the checkpoint was taken, i.e. where to resume reading
+return ((uint64_t)Get32(&input[6])<<32)|Get32(&input[2]);
+}
+// --------------------------------------------------------------------------------
+static void Put32(char * output,uint32_t x)
+{
+output[0]=x;
+output[1]=x>>8;
+output[2]=x>>16;
+output[3]=x>>24;
+}
+// --------------------------------------------------------------------------------
+static uint32_t Get32(char * input)
+{
+return ((uint32_t)(uint8_t)input[3]<<24)|((uint32_t)(uint8_t)input[2]<<16)|
+       ((uint32_t)(uint8_t)input[1]<<8) | (uint8_t)input[0];
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "hash.h"
+
+// Serialised in-progress hash state.  Layout (all multi-byte fields littleendian,
+// whatever the internal representation) :
+//   byte  0     : HASH_CHECKPOINT_VERSION
+//   byte  1     : algorithm (HASH_ID_xxx)
+//   bytes 2..9  : count of bytes absorbed so far
+//   then        : chaining words, 4 bytes each
+//   then        : (count & 0x3F) bytes of the pending partial block
+
+#define HASH_CHECKPOINT_VERSION   (1)
+#define HASH_CHECKPOINT_HEADER   (10)  // Version, algorithm and count
+#define HASH_CHECKPOINT_MAX     (105)  // Header + 32 state bytes + 63 pending bytes
+
+uint8_t  HashCheckpointSave(char * output,uint8_t id,JOINED * state,uint8_t stateBytes,
+                            uint32_t * count,uint8_t lsw);
+uint8_t  HashCheckpointRestore(char * input,uint8_t id,JOINED * state,uint8_t stateBytes,
+                               uint32_t * count,uint8_t lsw);
+uint64_t HashCheckpointBytes(char * input);
+
+#endif
\ No newline at end of file
@@ -1,2 +1,20 @@
-#define LITTLEENDIAN      // For AVR devices
-#define MSG_LENGTH  (68)  // Save space by using same char everywhere
+#define LITTLEENDIAN      // For AVR devices
+#define MSG_LENGTH  (68)  // Save space by using same char everywhere
+//#define HASH_STATS      // Hot path counters, see stats.c.  Costs speed, so normally off
+//#define HASH_THREADS    // Host only : buffer per thread, and pool.c runs on pthreads
+//#define HASH_LANES (4)  // Host only : MD5/RIPEMD160 batches interleave up to 2-4 messages, see lanes.c
+
+#include <limits.h>
+#if CHAR_MIN<0  // Byte handling throughout (e.g. SROTL in sha1.c) assumes char is unsigned
+#error "char must be unsigned : build with -funsigned-char"
+#endif
+
+#ifdef HASH_THREADS
+#define HASH_TLS  _Thread_local  // buffer must then be defined with HASH_TLS too
+#else
+#define HASH_TLS
+#endif
+
+#if defined(HASH_LANES) && (HASH_LANES<1 || HASH_LANES>4)
+#error "HASH_LANES must be 1 to 4 : the lane kernels have no wider instances"
+#endif
@@ -0,0 +1,77 @@
+/* Deduplication index of SHA-256 digests
+
+   Open addressing with linear probing over buckets of DEDUP_BUCKET_SLOTS digests,
+   each bucket one cache line, so a lookup normally touches a single line.  Digests
+   are already uniformly distributed, so their leading bytes are used directly as
+   the bucket number.  An all zero slot is empty.
+
+   Storage is provided by the caller, e.g. for 2^16 buckets (131,072 digests, 4MB) :
+
+     static DEDUP_BUCKET store[1UL<<16];
+     DedupInit(&index,store,1UL<<16);
+
+   and then for each chunk from cdc.c : DedupInsert(&index,buffer,cdc.size);
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "dedup.h"
+#include <string.h> // memcmp
+
+static const char empty[SHA256_RESULT_BYTES];  // All zero
+
+// --------------------------------------------------------------------------------
+void DedupInit(DEDUP_INDEX * index,DEDUP_BUCKET * storage,uint32_t buckets)
+{ // buckets must be a power of 2
+memset(storage,0,buckets*sizeof(DEDUP_BUCKET));
+memset(index,0,sizeof(*index));
+index->bucket=storage;
+index->mask=buckets-1;
+}
+// --------------------------------------------------------------------------------
+uint8_t DedupInsert(DEDUP_INDEX * index,char * digest,uint32_t size)
+{ // Records a chunk of size bytes with the given digest.  Returns DEDUP_NEW if it was
+  // not seen before (and is now stored), DEDUP_DUPLICATE if it was, or DEDUP_FULL.
+uint32_t b=((uint32_t)(uint8_t)digest[0]<<24)|((uint32_t)(uint8_t)digest[1]<<16)|
+           ((uint32_t)(uint8_t)digest[2]<<8) | (uint8_t)digest[3];
+
+for (uint32_t probe=0;probe<=index->mask;probe++,b++) {
+  DEDUP_BUCKET * bucket=&index->bucket[b&index->mask];
+  for (uint8_t s=0;s<DEDUP_BUCKET_SLOTS;s++) {
+    if (!memcmp(bucket->digest[s],digest,SHA256_RESULT_BYTES)) {
+      index->chunks++;
+      index->bytes+=size;
+      return DEDUP_DUPLICATE;
+    }
+    if (!memcmp(bucket->digest[s],empty,SHA256_RESULT_BYTES)) {
+      memcpy(bucket->digest[s],digest,SHA256_RESULT_BYTES);
+      index->chunks++;
+      index->unique++;
+      index->bytes+=size;
+      index->uniqueBytes+=size;
+      return DEDUP_NEW;
+    }
+  }
+}
+return DEDUP_FULL;
+}
+// --------------------------------------------------------------------------------
+uint16_t DedupPermille(DEDUP_INDEX * index)
+{ // Duplicate bytes, in parts per thousand of all bytes offered
+if (index->bytes==0) return 0;
+return (uint16_t)(((index->bytes-index->uniqueBytes)*1000)/index->bytes);
+}
@@ -0,0 +1,33 @@
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "sha256.h"
+
+// Open addressing index of SHA-256 chunk digests, for deduplication
+
+#define DEDUP_BUCKET_SLOTS  (2)  // Digests per bucket.  2x32 = one 64 byte cache line
+
+typedef struct {
+  char digest[DEDUP_BUCKET_SLOTS][SHA256_RESULT_BYTES];
+} __attribute__((aligned(DEDUP_BUCKET_SLOTS*SHA256_RESULT_BYTES))) DEDUP_BUCKET;
+
+typedef struct {
+  DEDUP_BUCKET * bucket;  // Caller provided storage
+  uint32_t mask;          // Number of buckets-1.  Number of buckets is a power of 2
+  uint32_t chunks;        // Digests offered
+  uint32_t unique;        // ... of which new
+  uint64_t bytes;         // Bytes those chunks represent
+  uint64_t uniqueBytes;   // ... of which new
+} DEDUP_INDEX;
+
+#define DEDUP_NEW        (0)
+#define DEDUP_DUPLICATE  (1)
+#define DEDUP_FULL       (2)
+
+void     DedupInit(DEDUP_INDEX *,DEDUP_BUCKET * storage,uint32_t buckets);
+uint8_t  DedupInsert(DEDUP_INDEX *,char * digest,uint32_t size);
+uint16_t DedupPermille(DEDUP_INDEX *);
+
+#endif
@@ -0,0 +1,268 @@
+/* Delta encoding against an old file, as rsync
+
+   The holder of the old file sends its signatures : per block of blockSize
+   bytes, a weak sum that can be rolled along a byte at a time and an MD5.
+   DeltaSignatures() computes them over the file in memory (e.g. mapped), blocks
+   being independent, in chunks on the work stealing pool.  Each block's MD5 goes
+   straight through the multi-block Transform from the file.
+
+   The holder of the new file indexes the signatures by weak sum in an open
+   addressed table (weak sums inline, so probing does not touch the signatures),
+   then streams the new file through DeltaUpdate().  The weak sum of the window is
+   rolled along byte by byte, and only where it is found in the table is the
+   window's MD5 computed and compared; on a match the whole window becomes a copy.
+   Runs of consecutive blocks coalesce into one copy, and among equal blocks the
+   one continuing the run is preferred.  Unmatched bytes are emitted as literals,
+   at most blockSize at a time.  An old file's short last block matches only at the
+   end of the new file.
+
+   The weak sum is rsync's : a=sum of bytes, b=sum of the running a, as a|b<<16.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "delta.h"
+#include "pool.h"
+#include <string.h> // memcpy
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define WEAK(A,B)  (((A)&0xFFFF)|((B)<<16))
+
+typedef struct {
+  char *      data;
+  uint64_t    length;
+  DELTA_SIG * sig;
+  uint16_t    blockSize;
+} SIGNING;
+
+static void SignChunk(void * arg,uint32_t first,uint32_t last);
+static void Strong(char * data,uint32_t length,char * output);
+static uint32_t Slot(DELTA_TABLE * table,uint32_t weak);
+static uint8_t Match(DELTA_CTX * context,char * data,uint32_t length);
+static void Literal(DELTA_CTX * context,uint32_t length);
+static void Flush(DELTA_CTX * context);
+
+// --------------------------------------------------------------------------------
+uint32_t DeltaBlocks(uint64_t length,uint16_t blockSize)
+{ // Signatures for a file of length bytes
+return (length+blockSize-1)/blockSize;
+}
+// --------------------------------------------------------------------------------
+uint32_t DeltaWeak(char * data,uint32_t length)
+{ // Weak sum of length bytes
+uint32_t a=0,b=0;
+
+for (uint32_t i=0;i<length;i++) {
+  a+=(uint8_t)data[i];
+  b+=a;
+}
+return WEAK(a,b);
+}
+// --------------------------------------------------------------------------------
+void DeltaSignatures(char * data,uint64_t length,uint16_t blockSize,DELTA_SIG * sig,uint8_t threads)
+{ // Signatures of the DeltaBlocks() blocks of data.  blockSize<=DELTA_MAX_BLOCK.
+  // threads 0 means PoolThreads().
+uint32_t bounds[POOL_MAX_CHUNKS+1];
+uint32_t blocks=DeltaBlocks(length,blockSize);
+uint32_t chunks;
+SIGNING  signing={data,length,sig,blockSize};
+
+if (blocks==0) return;
+if (threads==0) threads=PoolThreads();
+chunks=PoolSplit(bounds,blocks,threads);
+PoolRun(SignChunk,&signing,bounds,chunks,threads);
+}
+// --------------------------------------------------------------------------------
+uint8_t DeltaTableInit(DELTA_TABLE * table,DELTA_SIG * sig,uint64_t length,uint16_t blockSize,
+                       DELTA_SLOT * slot,uint8_t bits)
+{ // Indexes the signatures of an old file of length bytes.  slot holds 2^bits, which
+  // must be more than DeltaBlocks() so probing always ends at an empty slot.  Returns
+  // 1, or 0 (table untouched) if bits is not 1 to DELTA_MAX_BITS, 2^bits is too few
+  // or blockSize is not 1 to DELTA_MAX_BLOCK.
+if (blockSize==0 || blockSize>DELTA_MAX_BLOCK || bits==0 || bits>DELTA_MAX_BITS ||
+    (1UL<<bits)<=DeltaBlocks(length,blockSize)) return 0;
+
+table->sig=sig;
+table->slot=slot;
+table->length=length;
+table->blocks=DeltaBlocks(length,blockSize);
+table->blockSize=blockSize;
+table->bits=bits;
+
+memset(slot,0,sizeof(DELTA_SLOT)<<bits);
+for (uint32_t i=0;i<table->blocks;i++) {
+  uint32_t s=Slot(table,sig[i].weak);
+
+  while (slot[s].block) s=(s+1)&((1UL<<bits)-1);
+  slot[s].weak=sig[i].weak;
+  slot[s].block=i+1;
+}
+return 1;
+}
+// --------------------------------------------------------------------------------
+void DeltaInit(DELTA_CTX * context,DELTA_TABLE * table,char * window,DELTA_EMIT emit,void * arg)
+{ // Starts a new file.  window holds 2*table->blockSize chars.
+memset(context,0,sizeof(*context));
+context->table=table;
+context->window=window;
+context->emit=emit;
+context->arg=arg;
+}
+// --------------------------------------------------------------------------------
+void DeltaUpdate(DELTA_CTX * context,char * input,uint16_t inputLen)
+{ // The next inputLen bytes of the new file.  Operations are emitted as they are
+  // settled, so some lag behind the input.
+uint16_t size=context->table->blockSize;
+uint16_t i=0;
+
+while (i<inputLen) {
+  char * w=&context->window[context->literal];
+
+  if (context->have<size) {  // Filling an empty window after a match, or at the start
+    uint16_t n=size-context->have;
+
+    if (n>inputLen-i) n=inputLen-i;
+    memcpy(&w[context->have],&input[i],n);
+    context->have+=n;
+    i+=n;
+    if (context->have<size) break;
+    context->a=context->b=0;
+    for (uint16_t j=0;j<size;j++) {
+      context->a+=(uint8_t)w[j];
+      context->b+=context->a;
+    }
+  }
+  else {                     // Roll on one byte
+    uint8_t out=w[0];
+    uint8_t in=input[i++];
+
+    w[size]=in;
+    context->a+=in-out;
+    context->b+=context->a-(uint32_t)size*out;
+    context->literal++;
+    w++;
+    if (context->literal==size) {  // Window buffer full : hand on the literals
+      Literal(context,size);
+      memmove(context->window,w,size);
+      w=context->window;
+    }
+  }
+  if (Match(context,w,size)) context->have=0;
+}
+}
+// --------------------------------------------------------------------------------
+void DeltaFinal(DELTA_CTX * context)
+{ // Emits everything outstanding.  A tail matching the old file's short last block
+  // is a copy, the rest literal.
+DELTA_TABLE * table=context->table;
+uint16_t tail=table->length%table->blockSize;
+char * w=&context->window[context->literal];
+
+if (!(context->have<table->blockSize && context->have==tail && tail && Match(context,w,tail)))
+  context->literal+=context->have;
+context->have=0;
+Flush(context);
+if (context->literal) Literal(context,context->literal);
+}
+// --------------------------------------------------------------------------------
+static void SignChunk(void * arg,uint32_t first,uint32_t last)
+{
+SIGNING * s=(SIGNING *)arg;
+
+for (uint32_t i=first;i<last;i++) {
+  uint64_t offset=(uint64_t)i*s->blockSize;
+  uint32_t length=(s->length-offset<s->blockSize)?s->length-offset:s->blockSize;
+
+  s->sig[i].weak=DeltaWeak(&s->data[offset],length);
+  Strong(&s->data[offset],length,s->sig[i].strong);
+}
+}
+// --------------------------------------------------------------------------------
+static void Strong(char * data,uint32_t length,char * output)
+{
+MD5_CTX context;
+
+MD5Init(&context);
+MD5Update(&context,data,length);
+MD5Final(&context);
+memcpy(output,buffer,MD5_RESULT_BYTES);
+}
+// --------------------------------------------------------------------------------
+static uint32_t Slot(DELTA_TABLE * table,uint32_t weak)
+{ // Home slot of a weak sum
+return (uint32_t)((weak^(weak>>15))*0x9E3779B1UL)>>(32-table->bits);
+}
+// --------------------------------------------------------------------------------
+static uint8_t Match(DELTA_CTX * context,char * data,uint32_t length)
+{ // If the length bytes at data (the window, after any literals) match an old block,
+  // emits the literals and adds the block to the pending copy.  Returns 1 if so.
+DELTA_TABLE * table=context->table;
+uint32_t weak=(length==table->blockSize)?WEAK(context->a,context->b):DeltaWeak(data,length);
+uint32_t mask=(1UL<<table->bits)-1;
+uint32_t found=0;
+char strong[MD5_RESULT_BYTES];
+uint8_t hashed=0;
+
+for (uint32_t s=Slot(table,weak);table->slot[s].block;s=(s+1)&mask) {
+  uint32_t block=table->slot[s].block-1;
+  uint32_t blockLength=(block==table->blocks-1 && table->length%table->blockSize)?
+                       table->length%table->blockSize:table->blockSize;
+
+  if (table->slot[s].weak!=weak || blockLength!=length) continue;
+  if (!hashed) {             // Strong sum only now, and once however many candidates
+    context->weakHits++;
+    Strong(data,length,strong);
+    hashed=1;
+  }
+  if (memcmp(strong,table->sig[block].strong,MD5_RESULT_BYTES)) continue;
+  found=block+1;
+  if (block==context->next) break;  // Continues the current run : best
+}
+if (!found) {
+  context->falseHits+=hashed;
+  return 0;
+}
+
+uint64_t offset=(uint64_t)(found-1)*table->blockSize;
+
+if (context->literal) {      // Literals come first
+  Flush(context);
+  Literal(context,context->literal);
+}
+if (context->copyLength && context->copyOffset+context->copyLength!=offset) Flush(context);
+if (context->copyLength==0) context->copyOffset=offset;
+context->copyLength+=length;
+context->matchedBytes+=length;
+context->next=found;
+return 1;
+}
+// --------------------------------------------------------------------------------
+static void Literal(DELTA_CTX * context,uint32_t length)
+{ // Emits the first length bytes of the window buffer as literal, after any copy
+Flush(context);
+context->emit(context->arg,DELTA_LITERAL,0,length,context->window);
+context->literalBytes+=length;
+context->literal-=length;
+}
+// --------------------------------------------------------------------------------
+static void Flush(DELTA_CTX * context)
+{ // Emits the pending copy
+if (context->copyLength==0) return;
+context->emit(context->arg,DELTA_COPY,context->copyOffset,context->copyLength,NULL);
+context->copyLength=0;
+}
@@ -0,0 +1,65 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "md5.h"
+
+// rsync style delta : the old file's block signatures (rolling weak sum and MD5),
+// and the new file as copies of old blocks and literal bytes.  See delta.c
+
+#define DELTA_MAX_BLOCK  (32768)
+#define DELTA_MAX_BITS      (31)  // Of the table's 2^bits slots
+#define DELTA_COPY           (1)  // DELTA_EMIT operations
+#define DELTA_LITERAL        (2)
+
+typedef struct {
+  uint32_t weak;
+  char     strong[MD5_RESULT_BYTES];
+} DELTA_SIG;
+
+typedef struct {
+  uint32_t weak;
+  uint32_t block;        // Index into sig, plus 1.  0 for an empty slot
+} DELTA_SLOT;
+
+typedef struct {
+  DELTA_SIG  * sig;      // Caller storage, one per block of the old file
+  DELTA_SLOT * slot;     // Caller storage, a power of 2 of them, ideally >=2 per block
+  uint64_t length;       // Of the old file
+  uint32_t blocks;
+  uint16_t blockSize;
+  uint8_t  bits;         // log2 of slots
+} DELTA_TABLE;
+
+// Operation callback : copy length bytes of the old file from offset, or insert
+// length literal bytes from data (only valid during the call)
+typedef void (*DELTA_EMIT)(void * arg,uint8_t op,uint64_t offset,uint32_t length,char * data);
+
+typedef struct {
+  DELTA_TABLE * table;
+  DELTA_EMIT emit;
+  void *     arg;
+  char *     window;     // Caller storage, 2*blockSize chars
+  uint32_t   a,b;        // Rolling sums of the window
+  uint32_t   literal;    // Unmatched bytes held before the window
+  uint32_t   have;       // Bytes in the window
+  uint32_t   next;       // Block after the last match, preferred among equals
+  uint64_t   copyOffset; // Copy not yet emitted, extended while matches run on
+  uint64_t   copyLength;
+  uint64_t   literalBytes;
+  uint64_t   matchedBytes;
+  uint32_t   weakHits;   // Weak sum matches, each costing an MD5
+  uint32_t   falseHits;  // ... of which the MD5 did not match
+} DELTA_CTX;
+
+uint32_t DeltaBlocks(uint64_t length,uint16_t blockSize);
+uint32_t DeltaWeak(char * data,uint32_t length);
+void     DeltaSignatures(char * data,uint64_t length,uint16_t blockSize,DELTA_SIG * sig,uint8_t threads);
+uint8_t  DeltaTableInit(DELTA_TABLE *,DELTA_SIG * sig,uint64_t length,uint16_t blockSize,
+                        DELTA_SLOT * slot,uint8_t bits);
+void     DeltaInit(DELTA_CTX *,DELTA_TABLE * table,char * window,DELTA_EMIT emit,void * arg);
+void     DeltaUpdate(DELTA_CTX *,char * data,uint16_t length);
+void     DeltaFinal(DELTA_CTX *);
+
+#endif
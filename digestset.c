@@ -0,0 +1,141 @@
+/* Digest set : membership of a fresh digest in a large allow or deny list
+
+   Replaces a scan of *_MATCH() over the list.  Digests are held sorted in one
+   contiguous array, and the top prefixBits of each digest index a table of start
+   offsets, so a lookup is one read of the offset table and then normally a single
+   compare.  With prefixBits near log2(count) the table adds about 8 bytes per
+   digest (DigestSetBytes() reports the total).  On SSE2 hosts the first 16 bytes of
+   a digest are compared in a single instruction.
+
+   Batched queries first locate, and prefetch, every query's bucket and only then
+   compare, so the memory latency of the queries overlaps.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "digestset.h"
+#include <stdlib.h> // qsort
+#include <string.h> // memcmp
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define BATCH  (16)  // Queries located ahead of being compared
+
+static HASH_TLS uint8_t sortSize;  // qsort() has no context argument; per thread if threaded
+
+static int Compare(const void * x,const void * y);
+static uint32_t Prefix(DIGEST_SET * set,char * digest);
+static uint8_t Search(DIGEST_SET * set,char * digest,uint32_t from,uint32_t to);
+
+// --------------------------------------------------------------------------------
+void DigestSetBuild(DIGEST_SET * set,char * digests,uint32_t count,uint8_t size,
+                    uint32_t * bucket,uint8_t prefixBits)
+{ // Sorts digests in place, drops duplicates, and indexes them.  size>=16,
+  // prefixBits<=24 and bucket must hold (1<<prefixBits)+1 entries.
+uint32_t n=0;
+
+sortSize=size;
+qsort(digests,count,size,Compare);
+for (uint32_t i=0;i<count;i++)
+  if (n==0 || memcmp(&digests[(n-1)*size],&digests[i*size],size))
+    memmove(&digests[(n++)*size],&digests[i*size],size);
+
+set->digest=digests;
+set->bucket=bucket;
+set->count=n;
+set->size=size;
+set->prefixBits=prefixBits;
+
+uint32_t i=0;
+for (uint32_t p=0;p<=(1UL<<prefixBits);p++) {
+  while (i<n && Prefix(set,&digests[i*size])<p) i++;
+  bucket[p]=i;
+}
+}
+// --------------------------------------------------------------------------------
+uint8_t DigestSetContains(DIGEST_SET * set,char * digest)
+{
+uint32_t p=Prefix(set,digest);
+return Search(set,digest,set->bucket[p],set->bucket[p+1]);
+}
+// --------------------------------------------------------------------------------
+void DigestSetContainsBatch(DIGEST_SET * set,char * digests,uint32_t n,uint8_t * result)
+{ // result[i] is 1 if the i'th of n digests is in the set, else 0
+uint32_t p[BATCH];
+
+for (uint32_t i=0;i<n;i+=BATCH) {
+  uint8_t m=(n-i<BATCH)?n-i:BATCH;
+  char * q=&digests[i*set->size];
+
+  for (uint8_t j=0;j<m;j++) {
+    p[j]=Prefix(set,&q[j*set->size]);
+    __builtin_prefetch(&set->bucket[p[j]]);
+  }
+  for (uint8_t j=0;j<m;j++) 
+    __builtin_prefetch(&set->digest[set->bucket[p[j]]*set->size]);
+  for (uint8_t j=0;j<m;j++) 
+    result[i+j]=Search(set,&q[j*set->size],set->bucket[p[j]],set->bucket[p[j]+1]);
+}
+}
+// --------------------------------------------------------------------------------
+uint32_t DigestSetBytes(DIGEST_SET * set)
+{ // Memory used by the set : digests plus offset table
+return set->count*set->size+((1UL<<set->prefixBits)+1)*sizeof(uint32_t);
+}
+// --------------------------------------------------------------------------------
+uint32_t DigestSetRead(FILE * file,char * digests,uint32_t max,uint8_t size)
+{ // Bulk load of a file of concatenated binary digests, ready for DigestSetBuild().
+  // Returns the number read, at most max.
+return fread(digests,size,max,file);
+}
+// --------------------------------------------------------------------------------
+static uint8_t Search(DIGEST_SET * set,char * digest,uint32_t from,uint32_t to)
+{ // Scans the (short) sorted bucket
+for (uint32_t i=from;i<to;i++) {
+  char * d=&set->digest[i*set->size];
+#ifdef __SSE2__  // First 16 bytes at once : the order comes from the first that differs
+  __m128i  x=_mm_loadu_si128((__m128i *)d);
+  __m128i  y=_mm_loadu_si128((__m128i *)digest);
+  uint16_t equal=_mm_movemask_epi8(_mm_cmpeq_epi8(x,y));
+
+  if (equal!=0xFFFF) {
+    uint8_t k=__builtin_ctz(~equal);
+    if ((uint8_t)d[k]>(uint8_t)digest[k]) return 0;  // Passed where it would be
+    continue;
+  }
+  int c=memcmp(&d[16],&digest[16],set->size-16);
+#else
+  int c=memcmp(d,digest,set->size);
+#endif
+  if (c==0) return 1;
+  if (c>0)  return 0;  // Passed where it would be
+}
+return 0;
+}
+// --------------------------------------------------------------------------------
+static uint32_t Prefix(DIGEST_SET * set,char * digest)
+{
+uint32_t x=((uint32_t)(uint8_t)digest[0]<<24)|((uint32_t)(uint8_t)digest[1]<<16)|
+           ((uint32_t)(uint8_t)digest[2]<<8) | (uint8_t)digest[3];
+return (set->prefixBits)?(x>>(32-set->prefixBits)):0;
+}
+// --------------------------------------------------------------------------------
+static int Compare(const void * x,const void * y)
+{
+return memcmp(x,y,sortSize);
+}
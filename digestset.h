@@ -0,0 +1,26 @@
+#ifndef DIGESTSET_H
+#define DIGESTSET_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "hash.h"
+
+// Static set of digests of one size (MD5_RESULT_BYTES, SHA1_RESULT_BYTES etc) for
+// allow/deny list membership tests.  Sorted digests, indexed by leading bits.
+
+typedef struct {
+  char     * digest;      // count sorted digests of size bytes each (caller storage)
+  uint32_t * bucket;      // 2^prefixBits+1 start offsets into digest (caller storage)
+  uint32_t   count;
+  uint8_t    size;
+  uint8_t    prefixBits;  // Ideally c. log2(count), giving about one digest per bucket
+} DIGEST_SET;
+
+void     DigestSetBuild(DIGEST_SET *,char * digests,uint32_t count,uint8_t size,
+                        uint32_t * bucket,uint8_t prefixBits);
+uint8_t  DigestSetContains(DIGEST_SET *,char * digest);
+void     DigestSetContainsBatch(DIGEST_SET *,char * digests,uint32_t n,uint8_t * result);
+uint32_t DigestSetBytes(DIGEST_SET *);
+uint32_t DigestSetRead(FILE * file,char * digests,uint32_t max,uint8_t size);
+
+#endif
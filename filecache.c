@@ -0,0 +1,316 @@
+/* File digest cache : skips re-hashing files that have not changed
+
+   For integrity scans that hash the same, mostly unchanged, files again and again.
+   Each digest is stored under the file's identity : device, inode, size,
+   modification time (ns) and algorithm.  If all match on the next scan, the stored
+   digest is returned without reading the file.  The table is open addressed, in a
+   memory mapped file of 72 bytes a slot, doubled when it gets FILE_CACHE_MAX_LOAD
+   full.  A file changed while being hashed is not cached.
+
+   A changed file normally has a new mtime, but silent corruption (e.g. a failing
+   disk) does not.  In verify mode a sample of verifyPermille hits per thousand are
+   re-hashed anyway, and a disagreement reported as FILE_CACHE_CORRUPT.  The cached
+   digest is kept, so the file is reported again on the next scan.
+
+     FileCacheOpen(&cache,"/var/lib/scan.fc",1<<20,10);   // Verify 1% of hits
+     for (each file) FileCacheDigest(&cache,path,HASH_ID_SHA256,digest);
+     FileCacheReport(&cache,json,sizeof(json));
+     FileCacheClose(&cache);
+
+   Host only (POSIX.1-2008), one process at a time per cache file.  The table is in
+   host byte order.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define _POSIX_C_SOURCE 200809L  // ftruncate, pread, st_mtim
+
+#include "config.h"
+
+#ifndef __AVR__
+
+#include "filecache.h"
+#include "batch.h"
+#include <fcntl.h>
+#include <stdio.h>    // snprintf
+#include <stdlib.h>   // malloc
+#include <string.h>   // memcpy
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define READ_BYTES  (0x8000)  // Per read(), and so per Update()
+
+static int Map(FILE_CACHE * cache,uint32_t slots);
+static int Grow(FILE_CACHE * cache);
+static FILE_CACHE_ENTRY * Find(FILE_CACHE * cache,FILE_CACHE_ENTRY * key);
+static uint8_t HashFile(FILE_CACHE * cache,int fd,uint8_t alg,char * output);
+static void Identify(FILE_CACHE_ENTRY * key,struct stat * st,uint8_t alg);
+static uint8_t Sample(FILE_CACHE * cache);
+static uint64_t Now(void);
+
+// --------------------------------------------------------------------------------
+int FileCacheOpen(FILE_CACHE * cache,const char * path,uint32_t slots,uint16_t verifyPermille)
+{ // Opens, or creates with at least slots slots, the cache file.  Returns 0, or -1 if
+  // it cannot be opened, is not a cache made on this kind of host, or this build
+  // fails HashKnownAnswers() (so would store and compare wrong digests).
+struct stat st;
+uint32_t n=64;
+
+memset(cache,0,sizeof(*cache));
+cache->fd=-1;
+cache->verifyPermille=verifyPermille;
+cache->random=0x2545F491;
+if (!HashKnownAnswers()) return -1;
+if ((cache->fd=open(path,O_RDWR|O_CREAT,0644))<0 || fstat(cache->fd,&st)) goto fail;
+
+if (st.st_size==0) {         // New
+  if (slots>FILE_CACHE_MAX_SLOTS) slots=FILE_CACHE_MAX_SLOTS;
+  while (n<slots) n<<=1;
+  if (Map(cache,n)) goto fail;
+  memcpy(cache->header->magic,FILE_CACHE_MAGIC,sizeof(cache->header->magic));
+  cache->header->endian=FILE_CACHE_ENDIAN;
+  cache->header->slots=n;
+  return 0;
+}
+if ((uint64_t)st.st_size<sizeof(FILE_CACHE_HEADER)) goto fail;
+cache->mapBytes=st.st_size;
+cache->header=mmap(NULL,cache->mapBytes,PROT_READ|PROT_WRITE,MAP_SHARED,cache->fd,0);
+if (cache->header==MAP_FAILED) {
+  cache->header=NULL;
+  goto fail;
+}
+cache->entry=(FILE_CACHE_ENTRY *)&cache->header[1];
+if (memcmp(cache->header->magic,FILE_CACHE_MAGIC,sizeof(cache->header->magic)) || 
+    cache->header->endian!=FILE_CACHE_ENDIAN ||
+    cache->header->slots==0 || cache->header->slots>FILE_CACHE_MAX_SLOTS ||
+    (cache->header->slots&(cache->header->slots-1)) ||  // Find() masks with slots-1 ..
+    cache->header->used>=cache->header->slots ||        // .. and needs an empty slot
+    sizeof(FILE_CACHE_HEADER)+(uint64_t)cache->header->slots*sizeof(FILE_CACHE_ENTRY)!=cache->mapBytes) 
+  goto fail;
+return 0;
+
+fail:
+FileCacheClose(cache);
+return -1;
+}
+// --------------------------------------------------------------------------------
+void FileCacheClose(FILE_CACHE * cache)
+{
+if (cache->header) {
+  msync(cache->header,cache->mapBytes,MS_SYNC);
+  munmap(cache->header,cache->mapBytes);
+}
+if (cache->fd>=0) close(cache->fd);
+cache->header=NULL;
+cache->entry=NULL;
+cache->fd=-1;
+}
+// --------------------------------------------------------------------------------
+uint8_t FileCacheDigest(FILE_CACHE * cache,const char * path,uint8_t alg,char * output)
+{ // Digest of the file at path into output (HashDigestBytes(alg) chars), from the
+  // cache if the file is unchanged.  Returns FILE_CACHE_HIT, _MISS, _CORRUPT (output
+  // then holds the digest of the file as it is now) or _ERROR.
+FILE_CACHE_ENTRY key,after,* slot;
+struct stat st;
+uint8_t size=HashDigestBytes(alg);
+uint8_t result=FILE_CACHE_ERROR;
+int fd;
+
+if (size==0 || (fd=open(path,O_RDONLY))<0) return FILE_CACHE_ERROR;
+if (fstat(fd,&st)) goto done;
+Identify(&key,&st,alg);
+
+slot=Find(cache,&key);
+if (slot->alg && slot->size==key.size && slot->mtimeNs==key.mtimeNs) {  // Hit
+  cache->stats.hits++;
+  memcpy(output,slot->digest,size);
+  result=FILE_CACHE_HIT;
+  if (Sample(cache)) {
+    cache->stats.verified++;
+    if (HashFile(cache,fd,alg,output)==0) result=FILE_CACHE_ERROR;
+    else if (memcmp(output,slot->digest,size)) {
+      cache->stats.corrupt++;
+      result=FILE_CACHE_CORRUPT;
+    }
+  }
+  else cache->stats.bytesSkipped+=key.size;
+  goto done;
+}
+
+cache->stats.misses++;       // Miss, or changed since cached
+if (HashFile(cache,fd,alg,output)==0) goto done;
+result=FILE_CACHE_MISS;
+if (fstat(fd,&st)) goto done;
+Identify(&after,&st,alg);
+if (memcmp(&key,&after,sizeof(key))) goto done;  // Changed while hashed : don't cache
+
+if (slot->alg==0) {          // New file
+  if ((cache->header->used+1)*100>(uint64_t)cache->header->slots*FILE_CACHE_MAX_LOAD) {
+    if (Grow(cache)) goto done;
+    slot=Find(cache,&key);
+  }
+  cache->header->used++;
+}
+memcpy(key.digest,output,size);
+*slot=key;
+
+done:
+close(fd);
+return result;
+}
+// --------------------------------------------------------------------------------
+uint64_t FileCacheSavedNs(FILE_CACHE * cache)
+{ // Time saved by hits, estimated at the hashing rate of the misses
+FILE_CACHE_STATS * s=&cache->stats;
+
+if (s->bytesHashed==0) return 0;
+return (uint64_t)((double)s->bytesSkipped*s->hashNs/s->bytesHashed);
+}
+// --------------------------------------------------------------------------------
+uint16_t FileCacheReport(FILE_CACHE * cache,char * output,uint16_t size)
+{ // Statistics as one JSON object.  Returns length written (excluding the terminating
+  // 0), or 0 if size was too small.
+FILE_CACHE_STATS * s=&cache->stats;
+uint64_t lookups=s->hits+s->misses;
+int len;
+
+len=snprintf(output,size,
+  "{\"hits\":%llu,\"misses\":%llu,\"hitPermille\":%llu,\"verified\":%llu,\"corrupt\":%llu,"
+  "\"bytesHashed\":%llu,\"bytesSkipped\":%llu,\"hashMs\":%llu,\"savedMs\":%llu,"
+  "\"entries\":%lu,\"slots\":%lu}",
+  (unsigned long long)s->hits,(unsigned long long)s->misses,
+  (unsigned long long)(lookups?s->hits*1000/lookups:0),
+  (unsigned long long)s->verified,(unsigned long long)s->corrupt,
+  (unsigned long long)s->bytesHashed,(unsigned long long)s->bytesSkipped,
+  (unsigned long long)(s->hashNs/1000000),(unsigned long long)(FileCacheSavedNs(cache)/1000000),
+  (unsigned long)cache->header->used,(unsigned long)cache->header->slots);
+return (len<0 || len>=size)?0:len;
+}
+// --------------------------------------------------------------------------------
+static int Map(FILE_CACHE * cache,uint32_t slots)
+{ // Extends the file to slots slots (after the header), never shrinking it first, and
+  // maps it.  On failure the file is back to its old size and cache is untouched.
+uint64_t bytes=sizeof(FILE_CACHE_HEADER)+(uint64_t)slots*sizeof(FILE_CACHE_ENTRY);
+void *   map;
+
+if (ftruncate(cache->fd,bytes)) goto fail;
+map=mmap(NULL,bytes,PROT_READ|PROT_WRITE,MAP_SHARED,cache->fd,0);
+if (map==MAP_FAILED) goto fail;
+
+cache->header=map;
+cache->entry=(FILE_CACHE_ENTRY *)&cache->header[1];
+cache->mapBytes=bytes;
+return 0;
+
+fail:
+if (ftruncate(cache->fd,cache->mapBytes)) {}  // Best effort : back to the old size (0 if new)
+return -1;
+}
+// --------------------------------------------------------------------------------
+static int Grow(FILE_CACHE * cache)
+{ // Doubles the table, reinserting every entry.  The old table stays mapped, and in
+  // use if anything fails, until the new one is in place.
+FILE_CACHE_HEADER * header=cache->header;
+uint64_t bytes=(uint64_t)header->slots*sizeof(FILE_CACHE_ENTRY);
+uint64_t mapBytes=cache->mapBytes;
+FILE_CACHE_ENTRY * old;
+
+if (header->slots>=FILE_CACHE_MAX_SLOTS || (old=malloc(bytes))==NULL) return -1;
+memcpy(old,cache->entry,bytes);
+if (Map(cache,header->slots*2)) {
+  free(old);
+  return -1;
+}
+munmap(header,mapBytes);     // Same file : the new mapping already holds the header
+
+cache->header->slots*=2;
+memset(cache->entry,0,(uint64_t)cache->header->slots*sizeof(FILE_CACHE_ENTRY));
+for (uint32_t i=0;i<cache->header->slots/2;i++)
+  if (old[i].alg) *Find(cache,&old[i])=old[i];
+free(old);
+return 0;
+}
+// --------------------------------------------------------------------------------
+static FILE_CACHE_ENTRY * Find(FILE_CACHE * cache,FILE_CACHE_ENTRY * key)
+{ // Slot for key's file and algorithm (whatever its size and mtime), or the empty slot
+  // where it belongs
+uint64_t h=(key->ino*0x9E3779B97F4A7C15ULL)^(key->dev*0xC2B2AE3D27D4EB4FULL)^key->alg;
+uint32_t mask=cache->header->slots-1;
+
+for (uint32_t i=(h^(h>>29))&mask;;i=(i+1)&mask) {
+  FILE_CACHE_ENTRY * slot=&cache->entry[i];
+
+  if (slot->alg==0 || (slot->ino==key->ino && slot->dev==key->dev && slot->alg==key->alg)) 
+    return slot;
+}
+}
+// --------------------------------------------------------------------------------
+static uint8_t HashFile(FILE_CACHE * cache,int fd,uint8_t alg,char * output)
+{ // Hashes the whole file from its start.  Returns the digest size, or 0 on a read error.
+HASH_ANY_CTX ctx;
+uint64_t start=Now();
+uint8_t size=HashAnyInit(&ctx,alg);
+char * data=malloc(READ_BYTES);
+ssize_t n;
+off_t offset=0;
+
+if (data==NULL) return 0;
+while ((n=pread(fd,data,READ_BYTES,offset))>0) {
+  HashAnyUpdate(&ctx,data,n);
+  offset+=n;
+}
+free(data);
+HashAnyFinal(&ctx);
+if (n<0) return 0;
+memcpy(output,buffer,size);
+
+cache->stats.bytesHashed+=offset;
+cache->stats.hashNs+=Now()-start;
+return size;
+}
+// --------------------------------------------------------------------------------
+static void Identify(FILE_CACHE_ENTRY * key,struct stat * st,uint8_t alg)
+{
+memset(key,0,sizeof(*key));
+key->dev=st->st_dev;
+key->ino=st->st_ino;
+key->size=st->st_size;
+key->mtimeNs=(int64_t)st->st_mtim.tv_sec*1000000000+st->st_mtim.tv_nsec;
+key->alg=alg;
+}
+// --------------------------------------------------------------------------------
+static uint8_t Sample(FILE_CACHE * cache)
+{ // 1 for verifyPermille calls in a thousand (xorshift)
+uint32_t x=cache->random;
+
+x^=x<<13;
+x^=x>>17;
+x^=x<<5;
+cache->random=x;
+return (x%1000)<cache->verifyPermille;
+}
+// --------------------------------------------------------------------------------
+static uint64_t Now(void)
+{
+struct timespec t;
+
+clock_gettime(CLOCK_MONOTONIC,&t);
+return (uint64_t)t.tv_sec*1000000000+t.tv_nsec;
+}
+#endif
@@ -0,0 +1,64 @@
+#ifndef FILECACHE_H
+#define FILECACHE_H
+
+#include <stdint.h>
+#include "hash.h"
+
+// Host only (POSIX).  Persistent cache of file digests, keyed by file identity, in a
+// memory mapped table.  See filecache.c
+
+#define FILE_CACHE_MAGIC      "HASHFC1"
+#define FILE_CACHE_ENDIAN     (0x01020304)  // Table is in host byte order
+#define FILE_CACHE_MAX_LOAD   (75)          // Percent, before the table is doubled
+#define FILE_CACHE_MAX_SLOTS  (0x80000000UL)  // Largest power of 2 in the uint32_t slots
+
+#define FILE_CACHE_HIT        (1)           // FileCacheDigest() results
+#define FILE_CACHE_MISS       (2)
+#define FILE_CACHE_CORRUPT    (3)           // Sampled re-hash disagreed with the cache
+#define FILE_CACHE_ERROR      (0)
+
+typedef struct {
+  uint64_t dev;
+  uint64_t ino;
+  uint64_t size;
+  int64_t  mtimeNs;
+  uint8_t  alg;          // HASH_ID_xxx, 0 for an empty slot
+  uint8_t  pad[7];
+  char     digest[32];
+} FILE_CACHE_ENTRY;      // 72 bytes
+
+typedef struct {
+  char     magic[8];
+  uint32_t endian;
+  uint32_t slots;        // Power of 2
+  uint32_t used;
+  uint32_t pad;
+} FILE_CACHE_HEADER;
+
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t verified;     // Hits re-hashed in verify mode
+  uint64_t corrupt;      // ... that disagreed
+  uint64_t bytesHashed;
+  uint64_t bytesSkipped; // Size of files answered from the cache
+  uint64_t hashNs;       // Time spent hashing
+} FILE_CACHE_STATS;
+
+typedef struct {
+  FILE_CACHE_HEADER * header;
+  FILE_CACHE_ENTRY  * entry;
+  FILE_CACHE_STATS    stats;
+  uint64_t  mapBytes;
+  uint32_t  random;      // For verify sampling
+  uint16_t  verifyPermille;
+  int       fd;
+} FILE_CACHE;
+
+int      FileCacheOpen(FILE_CACHE *,const char * path,uint32_t slots,uint16_t verifyPermille);
+void     FileCacheClose(FILE_CACHE *);
+uint8_t  FileCacheDigest(FILE_CACHE *,const char * path,uint8_t alg,char * output);
+uint64_t FileCacheSavedNs(FILE_CACHE *);
+uint16_t FileCacheReport(FILE_CACHE *,char * output,uint16_t size);
+
+#endif
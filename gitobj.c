@@ -0,0 +1,351 @@
+/* Git object ids : blobs and trees without git
+
+   A blob's id is SHA1 of "blob <length>\0" followed by the content; a tree's is SHA1
+   of "tree <length>\0" followed by an entry "<mode> <name>\0<20 byte id>" per file,
+   link or non-empty subdirectory, in name order (a directory sorting as if its name
+   ended in '/').  The header is hashed first and the content streamed after it, so
+   nothing is ever concatenated.
+
+   GitTreeId() gives what git write-tree would for the directory with every file
+   added : the directory is walked breadth first (skipping .git), so each
+   directory's entries, and each depth, are contiguous.  All the blobs are then
+   hashed on the work stealing pool, balanced by size, and the trees level by level
+   from the deepest up, each level on the pool too.  Modes are as git records them
+   (100644, 100755 if user executable, 120000 for a symbolic link, whose blob is its
+   target, and 40000); other file types, .gitignore and submodules are not handled.
+
+   Threads need HASH_THREADS in config.h; otherwise the same calls run serially.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define _POSIX_C_SOURCE 200809L  // lstat, readlink, strdup
+
+#include "config.h"
+
+#ifndef __AVR__
+
+#include "gitobj.h"
+#include "sha1.h"
+#include "pool.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>    // sprintf
+#include <stdlib.h>   // malloc, qsort
+#include <string.h>   // memcpy
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define READ_BYTES     (0x8000)  // Per read(), and so per SHA1Update()
+#define NODE_OVERHEAD  (256)     // Weight of opening a file, in bytes, for balancing
+#define ENTRY_MAX      (6+1+255+1+GIT_ID_BYTES)  // "100644 name\0id"
+
+#define GIT_FILE       (0)       // Node kinds
+#define GIT_EXEC       (1)
+#define GIT_LINK       (2)
+#define GIT_TREE       (3)
+
+#define GIT_OK         (0)       // Node states
+#define GIT_EMPTY      (1)       // Tree with no files anywhere below : not an entry
+#define GIT_FAILED     (2)
+
+typedef struct {
+  char *   path;
+  uint64_t size;
+  uint32_t first;        // Trees : index of first child, children follow in git order
+  uint32_t children;
+  uint16_t name;         // Offset of the last component in path
+  uint16_t depth;        // Root 0
+  uint8_t  kind;
+  uint8_t  state;
+  char     id[GIT_ID_BYTES];
+} GIT_NODE;
+
+typedef struct {
+  GIT_NODE * node;
+  uint32_t   n;
+  uint32_t   allocated;
+} GIT_WALK;
+
+typedef struct {         // Directory entry, before it becomes a node
+  char *  name;
+  uint8_t kind;
+  uint64_t size;
+} GIT_ENTRY;
+
+static const char * const MODE[4]={"100644","100755","120000","40000"};
+
+static uint8_t Walk(GIT_WALK * walk,const char * root);
+static uint8_t Add(GIT_WALK * walk,char * path,uint16_t name,uint8_t kind,uint64_t size,
+                   uint16_t depth);
+static void Run(GIT_WALK * walk,POOL_TASK task,uint32_t from,uint32_t to,uint8_t weigh,
+                uint8_t threads);
+static void BlobChunk(void * arg,uint32_t first,uint32_t last);
+static void TreeChunk(void * arg,uint32_t first,uint32_t last);
+static void Tree(GIT_WALK * walk,GIT_NODE * node);
+static uint8_t Blob(GIT_NODE * node);
+static void Header(SHA1_CTX * context,const char * type,uint64_t length);
+static int Compare(const void * x,const void * y);
+
+// --------------------------------------------------------------------------------
+uint8_t GitBlobId(char * data,uint64_t length,char * output)
+{ // Id of a blob held in memory, GIT_ID_BYTES binary chars to output.  Returns 1.
+SHA1_CTX context;
+
+Header(&context,"blob",length);
+for (;length>READ_BYTES;length-=READ_BYTES,data+=READ_BYTES) SHA1Update(&context,data,READ_BYTES);
+SHA1Update(&context,data,length);
+SHA1Final(&context);
+memcpy(output,buffer,GIT_ID_BYTES);
+return 1;
+}
+// --------------------------------------------------------------------------------
+uint8_t GitBlobFile(const char * path,char * output)
+{ // Id of the file at path, as git hash-object (which follows symbolic links).
+  // Returns 1, or 0 if it cannot be read or changes size while being read.
+struct stat st;
+GIT_NODE node;
+
+if (stat(path,&st) || !S_ISREG(st.st_mode)) return 0;
+node.path=(char *)path;
+node.size=st.st_size;
+node.kind=GIT_FILE;
+if (Blob(&node)==0) return 0;
+memcpy(output,node.id,GIT_ID_BYTES);
+return 1;
+}
+// --------------------------------------------------------------------------------
+uint8_t GitTreeId(const char * path,char * output,uint8_t threads)
+{ // Id of the tree of the directory at path, as git write-tree would give with all its
+  // files added.  threads 0 means PoolThreads().  Returns 1, or 0 if anything below
+  // cannot be read.
+GIT_WALK walk={NULL,0,0};
+uint8_t ok=Walk(&walk,path);
+
+if (threads==0) threads=PoolThreads();
+if (ok) {
+  Run(&walk,BlobChunk,0,walk.n,1,threads);
+  for (uint32_t end=walk.n;end;) {  // Levels, deepest first
+    uint32_t start=end-1;
+
+    while (start && walk.node[start-1].depth==walk.node[end-1].depth) start--;
+    Run(&walk,TreeChunk,start,end,0,threads);
+    end=start;
+  }
+  for (uint32_t i=0;i<walk.n;i++) if (walk.node[i].state==GIT_FAILED) ok=0;
+  memcpy(output,walk.node[0].id,GIT_ID_BYTES);
+}
+for (uint32_t i=0;i<walk.n;i++) free(walk.node[i].path);
+free(walk.node);
+return ok;
+}
+// --------------------------------------------------------------------------------
+static uint8_t Walk(GIT_WALK * walk,const char * root)
+{ // Breadth first listing of root into walk->node, each directory's entries together
+  // and in git order.  Returns 1, or 0 if a directory cannot be listed.
+struct stat st;
+char * path;
+
+if (stat(root,&st) || !S_ISDIR(st.st_mode) || (path=strdup(root))==NULL) return 0;
+if (Add(walk,path,strlen(path),GIT_TREE,0,0)==0) return 0;
+
+for (uint32_t i=0;i<walk->n;i++) {
+  GIT_ENTRY * entry=NULL;
+  uint32_t n=0,allocated=0;
+  uint16_t name=strlen(walk->node[i].path)+1;
+  uint8_t ok=1;
+  struct dirent * d;
+  DIR * dir;
+
+  if (walk->node[i].kind!=GIT_TREE) continue;
+  if ((dir=opendir(walk->node[i].path))==NULL) return 0;
+  while ((d=readdir(dir))!=NULL) {
+    if (!strcmp(d->d_name,".") || !strcmp(d->d_name,"..") || !strcmp(d->d_name,".git")) continue;
+    if (n==allocated) {
+      GIT_ENTRY * more=realloc(entry,(allocated=2*allocated+16)*sizeof(GIT_ENTRY));
+      if ((ok=(more!=NULL))==0) break;
+      entry=more;
+    }
+    if ((ok=((path=malloc(name+strlen(d->d_name)+1))!=NULL))==0) break;
+    sprintf(path,"%s/%s",walk->node[i].path,d->d_name);
+    if (lstat(path,&st) || !(S_ISREG(st.st_mode) || S_ISLNK(st.st_mode) || S_ISDIR(st.st_mode))) {
+      free(path);            // Vanished, or not something git stores
+      continue;
+    }
+    entry[n].name=path;
+    entry[n].size=st.st_size;
+    entry[n++].kind=S_ISDIR(st.st_mode)?GIT_TREE:S_ISLNK(st.st_mode)?GIT_LINK:
+                    (st.st_mode&S_IXUSR)?GIT_EXEC:GIT_FILE;
+  }
+  closedir(dir);
+
+  walk->node[i].first=walk->n;
+  walk->node[i].children=n;
+  if (n) qsort(entry,n,sizeof(GIT_ENTRY),Compare);  // Full paths, but one parent : as names
+  for (uint32_t j=0;j<n;j++)
+    if (!ok) free(entry[j].name);
+    else ok=Add(walk,entry[j].name,name,entry[j].kind,entry[j].size,walk->node[i].depth+1);
+  free(entry);
+  if (!ok) return 0;
+}
+return 1;
+}
+// --------------------------------------------------------------------------------
+static uint8_t Add(GIT_WALK * walk,char * path,uint16_t name,uint8_t kind,uint64_t size,
+                   uint16_t depth)
+{ // Appends a node, taking ownership of path.  Returns 0 (path freed) if out of memory.
+if (walk->n==walk->allocated) {
+  GIT_NODE * more=realloc(walk->node,(walk->allocated=2*walk->allocated+64)*sizeof(GIT_NODE));
+  if (more==NULL) {
+    free(path);
+    return 0;
+  }
+  walk->node=more;
+}
+GIT_NODE * node=&walk->node[walk->n++];
+
+memset(node,0,sizeof(*node));
+node->path=path;
+node->name=name;
+node->kind=kind;
+node->size=size;
+node->depth=depth;
+return 1;
+}
+// --------------------------------------------------------------------------------
+static void Run(GIT_WALK * walk,POOL_TASK task,uint32_t from,uint32_t to,uint8_t weigh,
+                uint8_t threads)
+{ // task over nodes from..to-1 on the pool, in chunks of about equal file size if weigh
+  // is set, else of equal node count
+uint32_t bounds[POOL_MAX_CHUNKS+1];
+uint32_t chunks=0;
+uint64_t total=0,target,weight=0;
+
+for (uint32_t i=from;i<to;i++) total+=(weigh?walk->node[i].size:0)+NODE_OVERHEAD;
+target=total/((uint32_t)threads*POOL_CHUNKS_PER_THREAD)+1;
+
+bounds[0]=from;
+for (uint32_t i=from;i<to;i++) {  // Cut when a chunk reaches its share of the weight
+  weight+=(weigh?walk->node[i].size:0)+NODE_OVERHEAD;
+  if (weight>=target && chunks<POOL_MAX_CHUNKS-1) {
+    bounds[++chunks]=i+1;
+    weight=0;
+  }
+}
+if (bounds[chunks]<to) bounds[++chunks]=to;
+PoolRun(task,walk,bounds,chunks,threads);
+}
+// --------------------------------------------------------------------------------
+static void BlobChunk(void * arg,uint32_t first,uint32_t last)
+{
+GIT_WALK * walk=(GIT_WALK *)arg;
+
+for (uint32_t i=first;i<last;i++)
+  if (walk->node[i].kind!=GIT_TREE && Blob(&walk->node[i])==0) walk->node[i].state=GIT_FAILED;
+}
+// --------------------------------------------------------------------------------
+static void TreeChunk(void * arg,uint32_t first,uint32_t last)
+{
+GIT_WALK * walk=(GIT_WALK *)arg;
+
+for (uint32_t i=first;i<last;i++)
+  if (walk->node[i].kind==GIT_TREE) Tree(walk,&walk->node[i]);
+}
+// --------------------------------------------------------------------------------
+static void Tree(GIT_WALK * walk,GIT_NODE * node)
+{ // Id of a tree whose children all have theirs.  Empty if no child is an entry, and
+  // failed if any child failed.
+GIT_NODE * child=&walk->node[node->first];
+char entry[ENTRY_MAX];
+uint64_t length=0;
+SHA1_CTX context;
+
+for (uint32_t i=0;i<node->children;i++) {
+  if (child[i].state==GIT_FAILED) {
+    node->state=GIT_FAILED;
+    return;
+  }
+  if (child[i].state==GIT_OK)
+    length+=strlen(MODE[child[i].kind])+1+strlen(&child[i].path[child[i].name])+1+GIT_ID_BYTES;
+}
+if (length==0) node->state=GIT_EMPTY;  // Still gets the empty tree's id, for the root
+
+Header(&context,"tree",length);
+for (uint32_t i=0;i<node->children;i++) {
+  if (child[i].state!=GIT_OK) continue;
+  int n=sprintf(entry,"%s %s",MODE[child[i].kind],&child[i].path[child[i].name]);
+  memcpy(&entry[n+1],child[i].id,GIT_ID_BYTES);  // After the terminating 0
+  SHA1Update(&context,entry,n+1+GIT_ID_BYTES);
+}
+SHA1Final(&context);
+memcpy(node->id,buffer,GIT_ID_BYTES);
+}
+// --------------------------------------------------------------------------------
+static uint8_t Blob(GIT_NODE * node)
+{ // Id of a file or link node, streamed from the file (or link target).  Returns 1, or
+  // 0 if it cannot be read or its size is not node->size.
+SHA1_CTX context;
+uint64_t total=0;
+ssize_t n=-1;
+char * data=malloc((node->kind==GIT_LINK)?node->size+1:READ_BYTES);
+int fd;
+
+if (data==NULL) return 0;
+if (node->kind==GIT_LINK) {
+  if ((n=readlink(node->path,data,node->size+1))==(ssize_t)node->size) {
+    Header(&context,"blob",n);
+    SHA1Update(&context,data,n);
+    total=n;
+  }
+}
+else if ((fd=open(node->path,O_RDONLY))>=0) {
+  Header(&context,"blob",node->size);
+  while (total<=node->size && (n=read(fd,data,READ_BYTES))>0) {
+    SHA1Update(&context,data,n);
+    total+=n;
+  }
+  close(fd);
+}
+free(data);
+if (n<0 || total!=node->size) return 0;  // Unreadable, or changed since listed
+
+SHA1Final(&context);
+memcpy(node->id,buffer,GIT_ID_BYTES);
+return 1;
+}
+// --------------------------------------------------------------------------------
+static void Header(SHA1_CTX * context,const char * type,uint64_t length)
+{ // Starts an object : "<type> <length>\0"
+char header[32];
+
+SHA1Init(context);
+SHA1Update(context,header,snprintf(header,sizeof(header),"%s %llu",type,(unsigned long long)length)+1);
+}
+// --------------------------------------------------------------------------------
+static int Compare(const void * x,const void * y)
+{ // Git order : by bytes, a directory as if its name ended in '/'
+const GIT_ENTRY * a=x;
+const GIT_ENTRY * b=y;
+size_t la=strlen(a->name),lb=strlen(b->name);
+int c=memcmp(a->name,b->name,(la<lb)?la:lb);
+
+if (c || la==lb) return c;
+uint8_t ca=(la>lb)?a->name[lb]:(a->kind==GIT_TREE)?'/':0;
+uint8_t cb=(lb>la)?b->name[la]:(b->kind==GIT_TREE)?'/':0;
+return (ca>cb)-(ca<cb);
+}
+#endif
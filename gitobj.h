@@ -0,0 +1,16 @@
+#ifndef GITOBJ_H
+#define GITOBJ_H
+
+#include <stdint.h>
+#include "hash.h"
+
+// Host only (POSIX).  Git object ids (SHA1) of blobs and of whole directory trees,
+// as git hash-object and git write-tree give them.  See gitobj.c
+
+#define GIT_ID_BYTES  (20)    // SHA1_RESULT_BYTES
+
+uint8_t GitBlobId(char * data,uint64_t length,char * output);
+uint8_t GitBlobFile(const char * path,char * output);
+uint8_t GitTreeId(const char * path,char * output,uint8_t threads);
+
+#endif
@@ -1,26 +1,52 @@
-#ifndef HASH_H
-#define HASH_H
-
-#include "config.h"
-
-typedef struct { 
-  union {
-    uint32_t word32;
-    char * bytes;
-    struct {
-#ifdef LITTLEENDIAN
-      char lsb;
-      char slsb;
-      char smsb;
-      char msb;
-#else
-      char msb;
-      char smsb;
-      char slsb;
-      char lsb;
-#endif
-    };
-  };
-} JOINED;
-
+#ifndef HASH_H
+#define HASH_H
+
+#include "config.h"
+
+// Constant tables (round constants, rotations, permutations) are file scope and
+// read only.  On AVR they stay in flash rather than being copied to RAM, and must
+// be read through ROM_xxx(); elsewhere they are ordinary read only data.
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#define ROM             PROGMEM
+#define ROM_WORD32(x)   pgm_read_dword(&(x))
+#define ROM_BYTE(x)     pgm_read_byte(&(x))
+#else
+#define ROM
+#define ROM_WORD32(x)   (x)
+#define ROM_BYTE(x)     (x)
+#endif
+
+typedef struct { 
+  union {
+    uint32_t word32;  // Exactly 4 bytes on any host, as buffer is aliased as an array of these
+    struct {
+#ifdef LITTLEENDIAN
+      char lsb;
+      char slsb;
+      char smsb;
+      char msb;
+#else
+      char msb;
+      char smsb;
+      char slsb;
+      char lsb;
+#endif
+    };
+  };
+} JOINED;
+
+// Algorithm identifiers, as recorded in anything persisted or exchanged
+#define HASH_ID_MD5        (1)
+#define HASH_ID_SHA1       (2)
+#define HASH_ID_SHA256     (3)
+#define HASH_ID_RIPEMD160  (4)
+#define HASH_ID_BLAKE2S    (5)
+
+// One fragment of a scattered message, for the *UpdateV() functions
+typedef struct {
+  char *   base;
+  uint16_t len;
+} HASH_IOVEC;
+
 #endif
\ No newline at end of file
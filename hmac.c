@@ -0,0 +1,120 @@
+/* HMAC-SHA1 and HMAC-SHA256 with precomputed midstates
+
+   The padded key occupies exactly one block, so after absorbing key^ipad (or
+   key^opad) the buffer is empty and the context alone is the whole midstate.
+   It can therefore be copied by plain structure assignment and reused for any
+   number of messages.  For a general message :
+
+     HMACSHA1Init(&hmac,key,keyLength);      // Once per key
+     SHA1_CTX ctx=hmac.inner;
+     SHA1Update(&ctx,message,length); ...
+     HMACSHA1Final(&hmac,&ctx);              // MAC now in buffer
+
+   and for a message of up to HMAC_SHORT_xxx chars (counters, digests) just
+   HMACSHA1Short(&hmac,message,length), which costs exactly two Transforms.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "hmac.h"
+#include <string.h> // memcpy
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define IPAD      (0x36)
+#define OPAD      (0x5c)
+
+// --------------------------------------------------------------------------------
+void HMACSHA1Init(HMAC_SHA1_CTX * hmac,char * key,uint16_t keyLength)
+{
+char k[SHA1_INPUT_BYTES];
+
+memset(k,0,sizeof(k));
+if (keyLength>SHA1_INPUT_BYTES) {  // Long keys are replaced by their hash
+  SHA1Init(&hmac->inner);
+  SHA1Update(&hmac->inner,key,keyLength);
+  SHA1Final(&hmac->inner);
+  memcpy(k,buffer,SHA1_RESULT_BYTES);
+} else memcpy(k,key,keyLength);
+
+for (uint8_t i=0;i<SHA1_INPUT_BYTES;i++) k[i]^=IPAD;
+SHA1Init(&hmac->inner);
+SHA1Update(&hmac->inner,k,SHA1_INPUT_BYTES);
+
+for (uint8_t i=0;i<SHA1_INPUT_BYTES;i++) k[i]^=(IPAD^OPAD);
+SHA1Init(&hmac->outer);
+SHA1Update(&hmac->outer,k,SHA1_INPUT_BYTES);
+
+memset(k,0,sizeof(k));  // Clean sensitive intermediates
+}
+// --------------------------------------------------------------------------------
+void HMACSHA1Final(HMAC_SHA1_CTX * hmac,SHA1_CTX * inner)
+{ // Completes a message started from a copy of hmac->inner.  MAC to buffer.
+SHA1_CTX outer=hmac->outer;
+
+SHA1Final(inner);
+SHA1FinalBlock(&outer,buffer,SHA1_RESULT_BYTES);
+}
+// --------------------------------------------------------------------------------
+void HMACSHA1Short(HMAC_SHA1_CTX * hmac,char * data,uint8_t length)
+{ // MAC of up to HMAC_SHORT_SHA1 chars, which may lie in buffer.  MAC to buffer.
+SHA1_CTX ctx=hmac->inner;
+
+SHA1FinalBlock(&ctx,data,length);
+ctx=hmac->outer;
+SHA1FinalBlock(&ctx,buffer,SHA1_RESULT_BYTES);
+}
+// --------------------------------------------------------------------------------
+void HMACSHA256Init(HMAC_SHA256_CTX * hmac,char * key,uint16_t keyLength)
+{
+char k[SHA256_INPUT_BYTES];
+
+memset(k,0,sizeof(k));
+if (keyLength>SHA256_INPUT_BYTES) {  // Long keys are replaced by their hash
+  SHA256Init(&hmac->inner);
+  SHA256Update(&hmac->inner,key,keyLength);
+  SHA256Final(&hmac->inner);
+  memcpy(k,buffer,SHA256_RESULT_BYTES);
+} else memcpy(k,key,keyLength);
+
+for (uint8_t i=0;i<SHA256_INPUT_BYTES;i++) k[i]^=IPAD;
+SHA256Init(&hmac->inner);
+SHA256Update(&hmac->inner,k,SHA256_INPUT_BYTES);
+
+for (uint8_t i=0;i<SHA256_INPUT_BYTES;i++) k[i]^=(IPAD^OPAD);
+SHA256Init(&hmac->outer);
+SHA256Update(&hmac->outer,k,SHA256_INPUT_BYTES);
+
+memset(k,0,sizeof(k));  // Clean sensitive intermediates
+}
+// --------------------------------------------------------------------------------
+void HMACSHA256Final(HMAC_SHA256_CTX * hmac,SHA256_CTX * inner)
+{ // Completes a message started from a copy of hmac->inner.  MAC to buffer.
+SHA256_CTX outer=hmac->outer;
+
+SHA256Final(inner);
+SHA256FinalBlock(&outer,buffer,SHA256_RESULT_BYTES);
+}
+// --------------------------------------------------------------------------------
+void HMACSHA256Short(HMAC_SHA256_CTX * hmac,char * data,uint8_t length)
+{ // MAC of up to HMAC_SHORT_SHA256 chars, which may lie in buffer.  MAC to buffer.
+SHA256_CTX ctx=hmac->inner;
+
+SHA256FinalBlock(&ctx,data,length);
+ctx=hmac->outer;
+SHA256FinalBlock(&ctx,buffer,SHA256_RESULT_BYTES);
+}
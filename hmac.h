@@ -0,0 +1,33 @@
+#ifndef HMAC_H
+#define HMAC_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "sha1.h"
+#include "sha256.h"
+
+// HMAC (RFC 2104) keeping the keyed inner and outer midstates, so a key costs two
+// Transforms once, rather than two per message
+
+typedef struct {
+  SHA1_CTX inner;   // After absorbing key^ipad
+  SHA1_CTX outer;   // After absorbing key^opad
+} HMAC_SHA1_CTX;
+
+typedef struct {
+  SHA256_CTX inner;
+  SHA256_CTX outer;
+} HMAC_SHA256_CTX;
+
+#define HMAC_SHORT_SHA1    (SHA1_INPUT_BYTES-SHA1_SIZE_BYTES-1)      // Longest message for *Short()
+#define HMAC_SHORT_SHA256  (SHA256_INPUT_BYTES-SHA256_SIZE_BYTES-1)
+
+void HMACSHA1Init(HMAC_SHA1_CTX *,char * key,uint16_t keyLength);
+void HMACSHA1Final(HMAC_SHA1_CTX *,SHA1_CTX * inner);
+void HMACSHA1Short(HMAC_SHA1_CTX *,char * data,uint8_t length);
+
+void HMACSHA256Init(HMAC_SHA256_CTX *,char * key,uint16_t keyLength);
+void HMACSHA256Final(HMAC_SHA256_CTX *,SHA256_CTX * inner);
+void HMACSHA256Short(HMAC_SHA256_CTX *,char * data,uint8_t length);
+
+#endif
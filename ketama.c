@@ -0,0 +1,260 @@
+/* Ketama consistent hashing : which of a cluster of cache servers holds a key
+
+   Each server "name" gets 160 points on a 32 bit ring, 4 from each of the MD5s of
+   "name-0" to "name-39" (little endian words of the digest, as libketama, for equal
+   weights).  A key belongs to the server with the first point at or after the first
+   word of MD5(key), wrapping round.  Adding or removing a server moves only the keys
+   between its points and their predecessors.
+
+   Server names are short, so every point hash is one MD5FinalBlock() : one padded
+   block, one Transform, no Init/Update/Final.  Keys up to 55 characters take the
+   same path.
+
+   Points are kept sorted, for incremental KetamaJoin()/KetamaLeave() (a merge or a
+   compaction, O(points)), and also copied into Eytzinger (breadth first tree) order
+   for lookups.  The search then reads the array front to back, the top levels share
+   cache lines, and there is no branch on the comparison.  KetamaLookupBatch() walks
+   16 keys down the tree together, prefetching 4 levels ahead.
+
+   Server ids are the caller's (e.g. index into its own server table); equal points
+   go to the lower id.  Storage is the caller's, sized for capacity servers :
+   capacity*KETAMA_POINTS*(sizeof(KETAMA_POINT)+4+2)+6 bytes, i.e. c. 2.2kB a server,
+   so a host rather than microcontroller module in practice.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "ketama.h"
+#include "md5.h"
+#include <stdlib.h> // qsort
+#include <string.h> // memcpy
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define BATCH  (16)  // Keys walked down the tree together
+
+static uint8_t Points(char * name,uint8_t length,uint32_t * point);
+static uint8_t Present(KETAMA_RING * ring,uint16_t server);
+static uint32_t Fill(KETAMA_RING * ring,uint32_t i,uint32_t k);
+static void Layout(KETAMA_RING * ring);
+static uint32_t Search(KETAMA_RING * ring,uint32_t point);
+static int ComparePoint(const void * x,const void * y);
+static int CompareWord(const void * x,const void * y);
+
+// --------------------------------------------------------------------------------
+void KetamaInit(KETAMA_RING * ring,KETAMA_POINT * sorted,uint32_t * tree,uint16_t * owner,
+                uint16_t capacity)
+{ // Empty ring.  sorted needs capacity*KETAMA_POINTS entries, tree and owner one more.
+ring->sorted=sorted;
+ring->tree=tree;
+ring->owner=owner;
+ring->points=0;
+ring->first=0;
+ring->capacity=capacity;
+}
+// --------------------------------------------------------------------------------
+uint8_t KetamaBuild(KETAMA_RING * ring,HASH_IOVEC * names,uint16_t n)
+{ // Whole ring from scratch, server i being names[i].  Returns 1, or 0 (ring left
+  // empty) if there are more than capacity servers or a name is too long.
+ring->points=0;
+ring->first=0;
+if (n>ring->capacity) return 0;
+
+for (uint16_t i=0;i<n;i++) {
+  KETAMA_POINT * p=&ring->sorted[ring->points];
+
+  if (names[i].len>KETAMA_NAME_MAX ||  // Before Points() narrows it to uint8_t
+      Points(names[i].base,names[i].len,ring->tree)==0) {
+    ring->points=0;
+    return 0;
+  }
+  for (uint8_t j=0;j<KETAMA_POINTS;j++) {
+    p[j].point=ring->tree[j];
+    p[j].server=i;
+  }
+  ring->points+=KETAMA_POINTS;
+}
+qsort(ring->sorted,ring->points,sizeof(KETAMA_POINT),ComparePoint);
+Layout(ring);
+return 1;
+}
+// --------------------------------------------------------------------------------
+uint8_t KetamaJoin(KETAMA_RING * ring,char * name,uint8_t length,uint16_t server)
+{ // Adds a server, merging its points into the rest.  Returns 1, or 0 (ring unchanged)
+  // if the ring is full, the name too long or server already present.
+uint32_t * add=ring->tree;   // Tree is rebuilt anyway, so holds the new points meanwhile
+uint32_t i=ring->points;
+uint32_t w=ring->points+KETAMA_POINTS;
+uint8_t j=KETAMA_POINTS;
+
+if (ring->points/KETAMA_POINTS>=ring->capacity || server==KETAMA_NONE ||
+    Present(ring,server)) return 0;
+if (Points(name,length,add)==0) return 0;  // Before touching add
+qsort(add,KETAMA_POINTS,sizeof(uint32_t),CompareWord);
+
+while (j) {                  // Merge from the top down, in place
+  if (i && (ring->sorted[i-1].point>add[j-1] ||
+           (ring->sorted[i-1].point==add[j-1] && ring->sorted[i-1].server>server)))
+    ring->sorted[--w]=ring->sorted[--i];
+  else {
+    ring->sorted[--w].point=add[--j];
+    ring->sorted[w].server=server;
+  }
+}
+ring->points+=KETAMA_POINTS;
+Layout(ring);
+return 1;
+}
+// --------------------------------------------------------------------------------
+uint8_t KetamaLeave(KETAMA_RING * ring,uint16_t server)
+{ // Removes a server.  Returns 1, or 0 if it was not present.
+uint32_t n=0;
+
+for (uint32_t i=0;i<ring->points;i++)
+  if (ring->sorted[i].server!=server) ring->sorted[n++]=ring->sorted[i];
+if (n==ring->points) return 0;
+ring->points=n;
+Layout(ring);
+return 1;
+}
+// --------------------------------------------------------------------------------
+uint32_t KetamaHash(char * key,uint16_t length)
+{ // Position of key on the ring : first word (little endian) of MD5(key)
+MD5_CTX context;
+
+MD5Init(&context);
+if (length<=MD5_INPUT_BYTES-MD5_SIZE_BYTES-1) MD5FinalBlock(&context,key,length);
+else {
+  MD5Update(&context,key,length);
+  MD5Final(&context);
+}
+return ((uint32_t)(uint8_t)buffer[3]<<24)|((uint32_t)(uint8_t)buffer[2]<<16)|
+       ((uint32_t)(uint8_t)buffer[1]<<8) | (uint8_t)buffer[0];
+}
+// --------------------------------------------------------------------------------
+uint16_t KetamaLookup(KETAMA_RING * ring,char * key,uint16_t length)
+{ // Server holding key, or KETAMA_NONE if the ring is empty
+if (ring->points==0) return KETAMA_NONE;
+return ring->owner[Search(ring,KetamaHash(key,length))];
+}
+// --------------------------------------------------------------------------------
+void KetamaLookupBatch(KETAMA_RING * ring,HASH_IOVEC * keys,uint32_t n,uint16_t * server)
+{ // server[i] is KetamaLookup() of keys[i], for n keys.  Hashes a group of keys first,
+  // then takes them down the tree level by level, so their cache misses overlap.
+uint32_t point[BATCH],k[BATCH];
+
+for (uint32_t i=0;i<n;i+=BATCH) {
+  uint8_t m=(n-i<BATCH)?n-i:BATCH;
+
+  if (ring->points==0) {
+    for (uint8_t j=0;j<m;j++) server[i+j]=KETAMA_NONE;
+    continue;
+  }
+  for (uint8_t j=0;j<m;j++) {
+    point[j]=KetamaHash(keys[i+j].base,keys[i+j].len);
+    k[j]=1;
+  }
+  for (uint8_t more=1;more;) {
+    more=0;
+    for (uint8_t j=0;j<m;j++) 
+      if (k[j]<=ring->points) {
+        __builtin_prefetch(&ring->tree[16*k[j]]);  // Its descendants 4 levels down
+        k[j]=2*k[j]+(ring->tree[k[j]]<point[j]);
+        more=1;
+      }
+  }
+  for (uint8_t j=0;j<m;j++) {
+    k[j]>>=__builtin_ffsl(~k[j]);  // Back up past the right turns
+    server[i+j]=ring->owner[k[j]?k[j]:ring->first];
+  }
+}
+}
+// --------------------------------------------------------------------------------
+static uint8_t Points(char * name,uint8_t length,uint32_t * point)
+{ // The KETAMA_POINTS points of server name, in digest order
+char s[MD5_INPUT_BYTES];
+MD5_CTX context;
+
+if (length>KETAMA_NAME_MAX) return 0;
+memcpy(s,name,length);
+s[length]='-';
+
+for (uint8_t i=0;i<KETAMA_HASHES;i++) {
+  uint8_t n=length+1;
+
+  if (i>=10) s[n++]='0'+i/10;
+  s[n++]='0'+i%10;
+  MD5Init(&context);
+  MD5FinalBlock(&context,s,n);
+  for (uint8_t j=0;j<MD5_RESULT_BYTES;j+=4) 
+    *point++=((uint32_t)(uint8_t)buffer[j+3]<<24)|((uint32_t)(uint8_t)buffer[j+2]<<16)|
+             ((uint32_t)(uint8_t)buffer[j+1]<<8) | (uint8_t)buffer[j];
+}
+return 1;
+}
+// --------------------------------------------------------------------------------
+static uint8_t Present(KETAMA_RING * ring,uint16_t server)
+{
+for (uint32_t i=0;i<ring->points;i++)
+  if (ring->sorted[i].server==server) return 1;
+return 0;
+}
+// --------------------------------------------------------------------------------
+static void Layout(KETAMA_RING * ring)
+{ // Tree and owner from sorted
+uint32_t k=1;
+
+Fill(ring,0,1);
+while (2*k<=ring->points) k*=2;  // Leftmost node holds the smallest
+ring->first=k;
+}
+// --------------------------------------------------------------------------------
+static uint32_t Fill(KETAMA_RING * ring,uint32_t i,uint32_t k)
+{ // In order walk of the subtree at k, placing sorted points from i on.  Returns the
+  // next unplaced point.  Recursion is only log2(points) deep.
+if (k>ring->points) return i;
+i=Fill(ring,i,2*k);
+ring->tree[k]=ring->sorted[i].point;
+ring->owner[k]=ring->sorted[i].server;
+return Fill(ring,i+1,2*k+1);
+}
+// --------------------------------------------------------------------------------
+static uint32_t Search(KETAMA_RING * ring,uint32_t point)
+{ // Tree index of the first point >= point, wrapping to the smallest
+uint32_t k=1;
+
+while (k<=ring->points) k=2*k+(ring->tree[k]<point);
+k>>=__builtin_ffsl(~k);  // Back up past the right turns
+return k?k:ring->first;
+}
+// --------------------------------------------------------------------------------
+static int ComparePoint(const void * x,const void * y)
+{ // By point, then server
+const KETAMA_POINT * a=x;
+const KETAMA_POINT * b=y;
+
+if (a->point!=b->point) return (a->point<b->point)?-1:1;
+return (a->server<b->server)?-1:(a->server>b->server);
+}
+// --------------------------------------------------------------------------------
+static int CompareWord(const void * x,const void * y)
+{
+uint32_t a=*(const uint32_t *)x;
+uint32_t b=*(const uint32_t *)y;
+
+return (a<b)?-1:(a>b);
+}
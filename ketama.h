@@ -0,0 +1,38 @@
+#ifndef KETAMA_H
+#define KETAMA_H
+
+#include <stdint.h>
+#include "hash.h"
+
+// Ketama consistent hash ring on MD5 : 160 points a server, keys to the server with
+// the first point at or after the key's.  See ketama.c
+
+#define KETAMA_POINTS      (160)     // Per server
+#define KETAMA_HASHES       (40)     // MD5s per server, 4 points from each
+#define KETAMA_NAME_MAX     (51)     // Longest server name : "name-39" in one block
+#define KETAMA_NONE     (0xFFFF)     // Lookup on an empty ring
+
+typedef struct {
+  uint32_t point;
+  uint16_t server;
+} KETAMA_POINT;
+
+typedef struct {
+  KETAMA_POINT * sorted; // Caller storage, KETAMA_POINTS per server, in point order
+  uint32_t * tree;       // Caller storage, KETAMA_POINTS per server +1, Eytzinger order from [1]
+  uint16_t * owner;      // Caller storage, same size : server of each tree point
+  uint32_t   points;
+  uint32_t   first;      // Tree index of the smallest point, where lookups wrap to
+  uint16_t   capacity;   // Servers
+} KETAMA_RING;
+
+void     KetamaInit(KETAMA_RING *,KETAMA_POINT * sorted,uint32_t * tree,uint16_t * owner,
+                    uint16_t capacity);
+uint8_t  KetamaBuild(KETAMA_RING *,HASH_IOVEC * names,uint16_t n);
+uint8_t  KetamaJoin(KETAMA_RING *,char * name,uint8_t length,uint16_t server);
+uint8_t  KetamaLeave(KETAMA_RING *,uint16_t server);
+uint32_t KetamaHash(char * key,uint16_t length);
+uint16_t KetamaLookup(KETAMA_RING *,char * key,uint16_t length);
+void     KetamaLookupBatch(KETAMA_RING *,HASH_IOVEC * keys,uint32_t n,uint16_t * server);
+
+#endif
@@ -0,0 +1,161 @@
+/* Interleaved hashing of several MD5 or RIPEMD160 messages at once
+
+   A single MD5 or RIPEMD160 Transform is one long chain of dependent additions and
+   rotations, so a wide host core sits mostly idle waiting on it.  The kernels
+   MD5TransformLanes() and RIPEMD160TransformLanes() run the steps of up to
+   HASH_LANES independent messages in one instruction stream, step by step, so the
+   core has that many chains to overlap.  No SIMD is involved : every lane is plain
+   32 bit scalar code, and the gain is instruction level parallelism alone.
+
+   How many lanes pay depends on the core.  On a 16 register x86-64, MD5 gains up to
+   3 or 4 lanes; RIPEMD160, whose left and right lines are already two independent
+   chains, gains nothing past one lane (which still far outruns the 8-bit minded
+   RIPEMD160Transform()), hence LANES_RIPEMD160_MAX.
+
+   HashLanes() keeps width lanes busy from a list of jobs.  Each lane walks its
+   message's whole blocks in place, then a copy of the padded tail.  When a message
+   ends its digest is written out and the next job of the same algorithm takes the
+   lane, so short and long messages mix freely; once the list runs dry the last
+   messages finish at whatever width is left, down to the one lane instance of the
+   kernel.  Other algorithms go one at a time through HashOne().
+
+   Used by HashBatch() (batch.c) when HASH_LANES is defined, so each thread of the
+   pool runs its chunk of jobs interleaved.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#ifdef HASH_LANES
+
+#include "lanes.h"
+#include <string.h> // memcpy
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define LANE_BLOCK  (64)  // MD5_INPUT_BYTES, RIPEMD160_INPUT_BYTES
+
+typedef void (*LANE_TRANSFORM)(uint32_t * state,char ** block,uint8_t lanes);
+
+typedef struct {
+  char *   data;
+  uint32_t job;
+  uint32_t full;         // Whole blocks of data, compressed in place
+  uint32_t blocks;       // full, plus 1 or 2 of tail
+  uint32_t next;         // Next block to compress
+  char     tail[LANES_TAIL_BYTES];
+} LANE;
+
+// Initial chaining words : MD5 uses the first four of RIPEMD160's five
+static const uint32_t IV[5]={0x67452301,0xEFCDAB89,0x98BADCFE,0x10325476,0xC3D2E1F0};
+
+static void HashLanesAlg(HASH_JOB * jobs,uint32_t n,char * output,uint8_t width,uint8_t alg,
+                         LANE_TRANSFORM transform,uint8_t words);
+static void LaneStart(LANE * lane,HASH_JOB * job,uint32_t index);
+
+// --------------------------------------------------------------------------------
+void HashLanes(HASH_JOB * jobs,uint32_t n,char * output,uint8_t width)
+{ // Digest of jobs[i] to output[i*HASH_BATCH_STRIDE], zero padded to the stride (and
+  // all zero for an unknown algorithm), as HashBatch() but on the calling thread.
+  // width (1 to HASH_LANES, clipped) is the most MD5 messages in flight, and of
+  // RIPEMD160 too up to LANES_RIPEMD160_MAX.
+if (width<1) width=1;
+if (width>HASH_LANES) width=HASH_LANES;
+
+HashLanesAlg(jobs,n,output,width,HASH_ID_MD5,MD5TransformLanes,MD5_RESULT_BYTES/4);
+if (width>LANES_RIPEMD160_MAX) width=LANES_RIPEMD160_MAX;
+HashLanesAlg(jobs,n,output,width,HASH_ID_RIPEMD160,RIPEMD160TransformLanes,RIPEMD160_RESULT_BYTES/4);
+
+for (uint32_t i=0;i<n;i++) {
+  if (jobs[i].alg==HASH_ID_MD5 || jobs[i].alg==HASH_ID_RIPEMD160) continue;
+
+  char *  out=&output[i*HASH_BATCH_STRIDE];
+  uint8_t size=HashOne(jobs[i].alg,jobs[i].data,jobs[i].len);
+
+  memcpy(out,buffer,size);
+  memset(&out[size],0,HASH_BATCH_STRIDE-size);
+}
+}
+// --------------------------------------------------------------------------------
+static void HashLanesAlg(HASH_JOB * jobs,uint32_t n,char * output,uint8_t width,uint8_t alg,
+                         LANE_TRANSFORM transform,uint8_t words)
+{ // The jobs of alg only, width at a time.  Active lanes are kept at the front, with
+  // lane l's chaining words at state[l*words].
+LANE     lane[HASH_LANES];
+uint32_t state[HASH_LANES*5];
+char *   block[HASH_LANES];
+uint8_t  active=0;
+uint32_t queue=0;
+
+for (;;) {
+  for (;active<width && queue<n;queue++) {  // Refill
+    if (jobs[queue].alg!=alg) continue;
+    LaneStart(&lane[active],&jobs[queue],queue);
+    memcpy(&state[active*words],IV,words*4);
+    active++;
+  }
+  if (active==0) break;
+
+  for (uint8_t l=0;l<active;l++) {
+    LANE * p=&lane[l];
+    block[l]=(p->next<p->full)?&p->data[p->next*LANE_BLOCK]:&p->tail[(p->next-p->full)*LANE_BLOCK];
+    p->next++;
+  }
+  transform(state,block,active);
+
+  for (uint8_t l=0;l<active;) {
+    if (lane[l].next<lane[l].blocks) { l++; continue; }
+
+    char * out=&output[lane[l].job*HASH_BATCH_STRIDE];  // Digest is the words littleendian
+    for (uint8_t i=0;i<words;i++) {
+      uint32_t x=state[l*words+i];
+      out[4*i]  =x;
+      out[4*i+1]=x>>8;
+      out[4*i+2]=x>>16;
+      out[4*i+3]=x>>24;
+    }
+    memset(&out[words*4],0,HASH_BATCH_STRIDE-words*4);
+
+    if (--active!=l) {  // Last lane fills the gap
+      memcpy(&lane[l],&lane[active],sizeof(LANE));
+      memcpy(&state[l*words],&state[active*words],words*4);
+    }
+  }
+}
+memset(state,0,sizeof(state));  // Zeroise intermediate data
+memset(lane,0,sizeof(lane));
+}
+// --------------------------------------------------------------------------------
+static void LaneStart(LANE * lane,HASH_JOB * job,uint32_t index)
+{ // Sets lane up for job : the whole blocks in place, and the rest padded in tail as
+  // MD5Final() and RIPEMD160Final() pad (0x80, zeros, littleendian bit count)
+uint32_t rest=job->len%LANE_BLOCK;
+uint64_t bits=(uint64_t)job->len<<3;
+uint8_t  tailBlocks=(rest<LANE_BLOCK-8)?1:2;
+
+lane->data=job->data;
+lane->job=index;
+lane->full=job->len/LANE_BLOCK;
+lane->blocks=lane->full+tailBlocks;
+lane->next=0;
+
+memcpy(lane->tail,&job->data[lane->full*LANE_BLOCK],rest);
+lane->tail[rest]=0x80;
+memset(&lane->tail[rest+1],0,tailBlocks*LANE_BLOCK-rest-1);
+for (uint8_t i=0;i<8;i++) lane->tail[tailBlocks*LANE_BLOCK-8+i]=bits>>(8*i);
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef LANES_H
+#define LANES_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "batch.h"
+
+// Host only, with HASH_LANES in config.h.  Batches of MD5 and RIPEMD160 messages
+// hashed 2 to HASH_LANES at a time through interleaved kernels.  See lanes.c
+
+#if defined(HASH_LANES) && (HASH_LANES<1 || HASH_LANES>4)  // Kernels have cases 1 to 4 only
+#error "HASH_LANES must be 1 to 4"
+#endif
+
+#define LANES_TAIL_BYTES  (128)  // Padded last one or two blocks of a message
+
+#ifndef LANES_RIPEMD160_MAX  // Its two lines already fill a 16 register core; raise on wider ones
+#define LANES_RIPEMD160_MAX  (1)
+#endif
+
+void HashLanes(HASH_JOB * jobs,uint32_t n,char * output,uint8_t width);
+
+#endif
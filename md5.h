@@ -1,41 +1,62 @@
-#include <stdint.h>
-#include "hash.h"
-
-// Constants for MD5Transform routine.
-
-#define S11 7
-#define S12 12
-#define S13 17
-#define S14 22
-#define S21 5
-#define S22 9
-#define S23 14
-#define S24 20
-#define S31 4
-#define S32 11
-#define S33 16
-#define S34 23
-#define S41 6
-#define S42 10
-#define S43 15
-#define S44 21
-
-#define MD5_BUF_OFFSET     (4)
-#define MD5_INPUT_BYTES   (64)  // Input bytes at a time
-#define MD5_SIZE_BYTES     (8)  // Bytes for internal representation of size 
-#define MD5_RESULT_BYTES  (16)  // Hash result size in bytes
-#define MD5_LSW            (0)  // Least significant word for size
-#define MD5_MSW            (1)
-
-// MD5 context. 
-typedef struct {
-  JOINED state[MD5_RESULT_BYTES/4];
-  uint32_t count[MD5_SIZE_BYTES/4];
-} MD5_CTX;
-
-#define MD5_MATCH(X,Y) (memcmp((X),(Y),MD5_RESULT_BYTES))
-
-void MD5Init(MD5_CTX *);
-void MD5Update(MD5_CTX *,char * data,uint16_t length);
-void MD5AddExpandedHash(MD5_CTX * context,char * data);
-void MD5Final(MD5_CTX *);
\ No newline at end of file
+#ifndef MD5_H
+#define MD5_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "checkpoint.h"
+#include "arena.h"
+
+// Constants for MD5Transform routine.
+
+#define S11 7
+#define S12 12
+#define S13 17
+#define S14 22
+#define S21 5
+#define S22 9
+#define S23 14
+#define S24 20
+#define S31 4
+#define S32 11
+#define S33 16
+#define S34 23
+#define S41 6
+#define S42 10
+#define S43 15
+#define S44 21
+
+#define MD5_BUF_OFFSET     (4)
+#define MD5_INPUT_BYTES   (64)  // Input bytes at a time
+#define MD5_SIZE_BYTES     (8)  // Bytes for internal representation of size 
+#define MD5_RESULT_BYTES  (16)  // Hash result size in bytes
+#define MD5_LSW            (0)  // Least significant word for size
+#define MD5_MSW            (1)
+
+// MD5 context. 
+typedef struct {
+  JOINED state[MD5_RESULT_BYTES/4];
+  uint32_t count[MD5_SIZE_BYTES/4];
+} MD5_CTX;
+
+#define MD5_MATCH(X,Y) (memcmp((X),(Y),MD5_RESULT_BYTES))
+
+// Serialise/reinstate an in-progress hash, see checkpoint.c.  O needs HASH_CHECKPOINT_MAX chars
+#define MD5Save(C,O)    (HashCheckpointSave((O),HASH_ID_MD5,(C)->state,MD5_RESULT_BYTES,(C)->count,MD5_LSW))
+#define MD5Restore(C,I) (HashCheckpointRestore((I),HASH_ID_MD5,(C)->state,MD5_RESULT_BYTES,(C)->count,MD5_LSW))
+
+// Share buffer between many concurrent hashes, see arena.c.  Lease before each Update/Final
+#define MD5Lease(C,A,S) (ArenaLease((A),(S),(C)->count,MD5_LSW))
+
+void MD5Init(MD5_CTX *);
+void MD5Update(MD5_CTX *,char * data,uint16_t length);
+void MD5UpdateV(MD5_CTX *,HASH_IOVEC * iov,uint8_t n);
+void MD5UpdateRing(MD5_CTX *,char * ring,uint16_t size,uint16_t start,uint16_t length);
+void MD5AddExpandedHash(MD5_CTX * context,char * data);
+void MD5Final(MD5_CTX *);
+void MD5FinalBlock(MD5_CTX *,char * data,uint8_t length);
+void MD5Iterate(JOINED * digest,uint32_t n);
+#ifdef HASH_LANES
+void MD5TransformLanes(uint32_t * state,char ** block,uint8_t lanes);
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,243 @@
+/* Chunked Merkle manifests : firmware images verified chunk by chunk as they arrive
+
+   Hashing a whole over-the-air image and comparing once at the end only finds a bad
+   chunk after everything has been received and written to staging.  Instead the
+   image is cut into chunks of 2^shift chars, each with its own SHA256 leaf, and the
+   leaves are bound together by a Merkle root, as RFC 6962 : leaf = SHA256(0x00 ||
+   chunk), node = SHA256(0x01 || left || right), the left subtree of n leaves
+   holding the largest power of 2 less than n.  The prefixes keep a leaf from ever
+   passing for a node.
+
+   The device trusts only the manifest header, which must reach it authenticated
+   (signed, or with an HMAC, see hmac.c).  It then takes the leaves in order through
+   MerkleVerifyLeaf(), keeping them wherever it likes (e.g. in flash), while they are
+   folded into the root on a stack of complete subtrees : one digest per level, so
+   RAM is MERKLE_MAX_DEPTH+1 digests whatever the image size.  Once the leaves match
+   the root, each chunk, in any order, is checked against its leaf as soon as its
+   last char arrives; a bad chunk is reported at once and only it need be sent again.
+   A chunk that runs longer than it should is rejected as soon as it overruns.
+
+   MerkleBuild() makes the manifest on the host, the leaves hashed in parallel on the
+   work stealing pool (HASH_THREADS in config.h; otherwise serially).
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "merkle.h"
+#include "pool.h"
+#include <string.h> // memcpy
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define LEAF_PREFIX  (0x00)
+#define NODE_PREFIX  (0x01)
+
+typedef struct {
+  char *   image;
+  uint32_t length;
+  char *   leaf;         // First leaf of the manifest
+  uint8_t  shift;
+} BUILDING;
+
+static void LeafChunk(void * arg,uint32_t first,uint32_t last);
+static void Leaf(char * data,uint16_t length,char * output);
+static void Node(char * left,char * right,char * output);
+static void Push(MERKLE_CTX * context,char * leaf);
+static void Root(MERKLE_CTX * context,char * output);
+static uint32_t Get32(char * input);
+static void Put32(char * output,uint32_t x);
+
+// --------------------------------------------------------------------------------
+uint32_t MerkleChunks(uint32_t length,uint8_t shift)
+{ // Chunks of 2^shift chars, the last possibly short, in an image of length chars
+return (uint32_t)(((uint64_t)length+(1UL<<shift)-1)>>shift);
+}
+// --------------------------------------------------------------------------------
+uint32_t MerkleManifestBytes(uint32_t length,uint8_t shift)
+{
+return MERKLE_HEADER_BYTES+MerkleChunks(length,shift)*MERKLE_DIGEST_BYTES;
+}
+// --------------------------------------------------------------------------------
+uint32_t MerkleBuild(char * image,uint32_t length,uint8_t shift,char * manifest,uint8_t threads)
+{ // Writes the manifest of image to manifest (MerkleManifestBytes() chars) and returns
+  // its length, or 0 if the image is empty, shift is out of range or there would be
+  // more than 2^MERKLE_MAX_DEPTH chunks.  threads 0 means PoolThreads().
+uint32_t   bounds[POOL_MAX_CHUNKS+1];
+uint32_t   chunks=MerkleChunks(length,shift);
+uint32_t   parts;
+BUILDING   building={image,length,&manifest[MERKLE_HEADER_BYTES],shift};
+MERKLE_CTX context;
+
+if (shift<MERKLE_MIN_SHIFT || shift>MERKLE_MAX_SHIFT ||
+    chunks==0 || chunks>(1UL<<MERKLE_MAX_DEPTH)) return 0;
+
+if (threads==0) threads=PoolThreads();
+parts=PoolSplit(bounds,chunks,threads);
+PoolRun(LeafChunk,&building,bounds,parts,threads);
+
+memset(&context,0,sizeof(context));
+for (uint32_t i=0;i<chunks;i++) Push(&context,&building.leaf[i*MERKLE_DIGEST_BYTES]);
+
+memcpy(manifest,MERKLE_MAGIC,8);
+manifest[8]=shift;
+manifest[9]=manifest[10]=manifest[11]=0;
+Put32(&manifest[12],length);
+Root(&context,&manifest[16]);
+return MerkleManifestBytes(length,shift);
+}
+// --------------------------------------------------------------------------------
+uint8_t MerkleVerifyInit(MERKLE_CTX * context,char * header)
+{ // Starts verification against a manifest header (its first MERKLE_HEADER_BYTES
+  // chars), which must already be known to be authentic.  Returns MERKLE_MORE, the
+  // leaves to follow, or MERKLE_BAD if the header is malformed or too big for
+  // MERKLE_MAX_DEPTH.
+memset(context,0,sizeof(*context));
+
+if (memcmp(header,MERKLE_MAGIC,8) || (uint8_t)header[8]<MERKLE_MIN_SHIFT ||
+    (uint8_t)header[8]>MERKLE_MAX_SHIFT || header[9] || header[10] || header[11]) return MERKLE_BAD;
+
+context->shift=header[8];
+context->length=Get32(&header[12]);
+context->chunks=MerkleChunks(context->length,context->shift);
+if (context->chunks==0 || context->chunks>(1UL<<MERKLE_MAX_DEPTH)) return MERKLE_BAD;
+
+memcpy(context->root,&header[16],MERKLE_DIGEST_BYTES);
+return MERKLE_MORE;
+}
+// --------------------------------------------------------------------------------
+uint8_t MerkleVerifyLeaf(MERKLE_CTX * context,char * leaf)
+{ // Folds in the manifest's next leaf; all must come, in order, before any chunk.
+  // Returns MERKLE_MORE until the last, then MERKLE_OK if the leaves give the root
+  // (so the caller's copy of them can be trusted), otherwise MERKLE_BAD.
+char root[MERKLE_DIGEST_BYTES];
+
+if (context->leaves>=context->chunks) return MERKLE_BAD;  // One too many
+
+Push(context,leaf);
+if (context->leaves<context->chunks) return MERKLE_MORE;
+
+Root(context,root);
+context->trusted=(memcmp(root,context->root,MERKLE_DIGEST_BYTES)==0);
+return context->trusted?MERKLE_OK:MERKLE_BAD;
+}
+// --------------------------------------------------------------------------------
+uint32_t MerkleChunkLength(MERKLE_CTX * context,uint32_t chunk)
+{ // Chars in chunk, 0 if past the end
+if (chunk>=context->chunks) return 0;
+if (chunk<context->chunks-1) return 1UL<<context->shift;
+return context->length-(chunk<<context->shift);
+}
+// --------------------------------------------------------------------------------
+void MerkleChunkBegin(MERKLE_CTX * context,uint32_t chunk)
+{ // Starts receiving chunk, in any order, and again after a MERKLE_BAD.  buffer
+  // belongs to the chunk until MerkleChunkEnd().
+char prefix=LEAF_PREFIX;
+
+context->chunk=chunk;
+context->received=0;
+SHA256Init(&context->sha);
+SHA256Update(&context->sha,&prefix,1);
+}
+// --------------------------------------------------------------------------------
+uint8_t MerkleChunkUpdate(MERKLE_CTX * context,char * data,uint16_t length)
+{ // Adds the next length chars of the chunk.  Returns MERKLE_MORE, or MERKLE_BAD at
+  // once (without taking them) if they would overrun the chunk.
+if (context->received+length>MerkleChunkLength(context,context->chunk)) return MERKLE_BAD;
+
+context->received+=length;
+SHA256Update(&context->sha,data,length);
+return MERKLE_MORE;
+}
+// --------------------------------------------------------------------------------
+uint8_t MerkleChunkEnd(MERKLE_CTX * context,char * leaf)
+{ // Checks the chunk against leaf, the trusted manifest's leaf for it.  MERKLE_OK :
+  // the chunk is authentic and can be kept.  MERKLE_BAD : discard it and ask for it
+  // again.  Always MERKLE_BAD until MerkleVerifyLeaf() has given MERKLE_OK.
+uint8_t ok;
+
+SHA256Final(&context->sha);
+ok=(context->trusted && context->received==MerkleChunkLength(context,context->chunk) &&
+    context->received && SHA256_MATCH(buffer,leaf)==0);
+return ok?MERKLE_OK:MERKLE_BAD;
+}
+// --------------------------------------------------------------------------------
+static void LeafChunk(void * arg,uint32_t first,uint32_t last)
+{
+BUILDING * b=(BUILDING *)arg;
+
+for (uint32_t i=first;i<last;i++) {
+  uint32_t offset=i<<b->shift;
+  uint32_t length=(b->length-offset<(1UL<<b->shift))?b->length-offset:(1UL<<b->shift);
+
+  Leaf(&b->image[offset],length,&b->leaf[i*MERKLE_DIGEST_BYTES]);
+}
+}
+// --------------------------------------------------------------------------------
+static void Leaf(char * data,uint16_t length,char * output)
+{ // SHA256(0x00 || data)
+SHA256_CTX context;
+char       prefix=LEAF_PREFIX;
+
+SHA256Init(&context);
+SHA256Update(&context,&prefix,1);
+SHA256Update(&context,data,length);
+SHA256Final(&context);
+memcpy(output,buffer,MERKLE_DIGEST_BYTES);
+}
+// --------------------------------------------------------------------------------
+static void Node(char * left,char * right,char * output)
+{ // SHA256(0x01 || left || right).  output may be left or right.
+SHA256_CTX context;
+char       prefix=NODE_PREFIX;
+HASH_IOVEC iov[3]={{&prefix,1},{left,MERKLE_DIGEST_BYTES},{right,MERKLE_DIGEST_BYTES}};
+
+SHA256Init(&context);
+SHA256UpdateV(&context,iov,3);
+SHA256Final(&context);
+memcpy(output,buffer,MERKLE_DIGEST_BYTES);
+}
+// --------------------------------------------------------------------------------
+static void Push(MERKLE_CTX * context,char * leaf)
+{ // Stacks leaf, then merges equal sized subtrees : one per trailing 0 bit of the new
+  // leaf count, so the stack holds a complete subtree per 1 bit, largest at the bottom
+memcpy(context->stack[context->top++],leaf,MERKLE_DIGEST_BYTES);
+
+for (uint32_t n=++context->leaves;(n&1)==0;n>>=1,context->top--)
+  Node(context->stack[context->top-2],context->stack[context->top-1],context->stack[context->top-2]);
+}
+// --------------------------------------------------------------------------------
+static void Root(MERKLE_CTX * context,char * output)
+{ // Folds the stack from the top (smallest subtree) down, which splits each level at
+  // the largest power of 2, as RFC 6962.  Consumes the stack.
+for (;context->top>1;context->top--)
+  Node(context->stack[context->top-2],context->stack[context->top-1],context->stack[context->top-2]);
+memcpy(output,context->stack[0],MERKLE_DIGEST_BYTES);
+}
+// --------------------------------------------------------------------------------
+static uint32_t Get32(char * input)
+{
+return ((uint32_t)(uint8_t)input[3]<<24)|((uint32_t)(uint8_t)input[2]<<16)|
+       ((uint32_t)(uint8_t)input[1]<<8) | (uint8_t)input[0];
+}
+// --------------------------------------------------------------------------------
+static void Put32(char * output,uint32_t x)
+{
+output[0]=x;
+output[1]=x>>8;
+output[2]=x>>16;
+output[3]=x>>24;
+}
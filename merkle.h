@@ -0,0 +1,57 @@
+#ifndef MERKLE_H
+#define MERKLE_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "sha256.h"
+
+// Chunked Merkle manifest of an image (e.g. firmware) : a SHA256 leaf per chunk and
+// their root, so each chunk can be verified as it arrives.  See merkle.c
+//
+// Manifest layout (endian independent) :
+//   bytes  0..7  : MERKLE_MAGIC
+//   byte   8     : log2 of the chunk size
+//   bytes  9..11 : 0
+//   bytes 12..15 : image length, littleendian
+//   bytes 16..47 : root
+//   then         : one leaf per chunk, MERKLE_DIGEST_BYTES each
+
+#define MERKLE_MAGIC         "HASHMK1"
+#define MERKLE_HEADER_BYTES  (48)
+#define MERKLE_DIGEST_BYTES  (32)  // SHA256_RESULT_BYTES
+#define MERKLE_MIN_SHIFT      (6)  // Chunks of 64 ..
+#define MERKLE_MAX_SHIFT     (15)  // .. to 32768 chars, as Update() takes them
+#ifndef MERKLE_MAX_DEPTH
+#define MERKLE_MAX_DEPTH     (12)  // Up to 2^12 chunks, for 32 bytes of context RAM a level
+#endif
+
+#define MERKLE_BAD            (0)  // Results
+#define MERKLE_OK             (1)
+#define MERKLE_MORE           (2)  // So far so good
+
+typedef struct {
+  SHA256_CTX sha;        // Chunk being received
+  char     stack[MERKLE_MAX_DEPTH+1][MERKLE_DIGEST_BYTES];  // Roots of complete subtrees
+  char     root[MERKLE_DIGEST_BYTES];
+  uint32_t length;       // Of the image
+  uint32_t chunks;
+  uint32_t leaves;       // Folded into stack so far
+  uint32_t chunk;        // Being received
+  uint32_t received;     // ... chars of it so far
+  uint8_t  shift;
+  uint8_t  top;          // Entries on stack
+  uint8_t  trusted;      // Every leaf folded, and the root matched
+} MERKLE_CTX;
+
+uint32_t MerkleChunks(uint32_t length,uint8_t shift);
+uint32_t MerkleManifestBytes(uint32_t length,uint8_t shift);
+uint32_t MerkleBuild(char * image,uint32_t length,uint8_t shift,char * manifest,uint8_t threads);
+
+uint8_t  MerkleVerifyInit(MERKLE_CTX *,char * header);
+uint8_t  MerkleVerifyLeaf(MERKLE_CTX *,char * leaf);
+uint32_t MerkleChunkLength(MERKLE_CTX *,uint32_t chunk);
+void     MerkleChunkBegin(MERKLE_CTX *,uint32_t chunk);
+uint8_t  MerkleChunkUpdate(MERKLE_CTX *,char * data,uint16_t length);
+uint8_t  MerkleChunkEnd(MERKLE_CTX *,char * leaf);
+
+#endif
@@ -0,0 +1,105 @@
+/* One time passwords : HOTP (RFC 4226) and TOTP (RFC 6238)
+
+   A code is HMAC(key,counter) of the 8 byte bigendian counter, dynamically
+   truncated to 31 bits and reduced to a number of decimal digits.  TOTP is HOTP
+   with counter OtpStep(time,period), normally period 30 s.
+
+   OtpInit() keeps the key's inner and outer HMAC midstates (see hmac.c), once per
+   key, so every code after is the single block inner and outer compressions of
+   HMACxxxShort() : 2 Transforms, rather than 4 from scratch.  OtpVerify() then
+   computes every code in the drift window, counter-behind .. counter+ahead, and
+   compares them all without stopping at a match, so its time does not reveal where
+   (or whether) the code matched.  The match nearest the expected counter wins.
+
+     OtpInit(&user,HASH_ID_SHA1,secret,20,6);          // Once per user
+     if (OtpVerify(&user,code,OtpStep(time(NULL),30),2,2,&drift)) ...
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "otp.h"
+#include <string.h> // memset
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define OTP_BUF_OFFSET  (4)  // Same as SHA1_BUF_OFFSET and SHA256_BUF_OFFSET
+#define COUNTER_BYTES   (8)
+
+// --------------------------------------------------------------------------------
+uint8_t OtpInit(OTP_KEY * otp,uint8_t alg,char * key,uint16_t keyLength,uint8_t digits)
+{ // Returns 1, or 0 if alg is not HASH_ID_SHA1 or HASH_ID_SHA256 or digits is not
+  // 1 to OTP_MAX_DIGITS.  Wipe otp when done, it is as sensitive as the key.
+if (digits==0 || digits>OTP_MAX_DIGITS) return 0;
+
+otp->alg=alg;
+otp->modulus=1;
+while (digits--) otp->modulus*=10;
+if (alg==HASH_ID_SHA1) HMACSHA1Init(&otp->sha1,key,keyLength);
+else if (alg==HASH_ID_SHA256) HMACSHA256Init(&otp->sha256,key,keyLength);
+else return 0;
+return 1;
+}
+// --------------------------------------------------------------------------------
+uint32_t OtpCode(OTP_KEY * otp,uint64_t counter)
+{ // HOTP code for counter
+char * c=&buffer[OTP_BUF_OFFSET];  // Built in place, HMACxxxShort() accepts that
+uint8_t size,offset;
+
+for (int8_t i=COUNTER_BYTES-1;i>=0;i--,counter>>=8) c[i]=counter;
+if (otp->alg==HASH_ID_SHA1) {
+  HMACSHA1Short(&otp->sha1,c,COUNTER_BYTES);
+  size=SHA1_RESULT_BYTES;
+}
+else {
+  HMACSHA256Short(&otp->sha256,c,COUNTER_BYTES);
+  size=SHA256_RESULT_BYTES;
+}
+offset=buffer[size-1]&0x0F;  // Dynamic truncation
+return ((((uint32_t)buffer[offset]&0x7F)<<24)|((uint32_t)(uint8_t)buffer[offset+1]<<16)|
+        ((uint32_t)(uint8_t)buffer[offset+2]<<8)|(uint8_t)buffer[offset+3])%otp->modulus;
+}
+// --------------------------------------------------------------------------------
+void OtpCodes(OTP_KEY * otp,uint64_t counter,uint16_t n,uint32_t * codes)
+{ // Codes for counter .. counter+n-1
+for (uint16_t i=0;i<n;i++) codes[i]=OtpCode(otp,counter+i);
+}
+// --------------------------------------------------------------------------------
+uint8_t OtpVerify(OTP_KEY * otp,uint32_t code,uint64_t counter,uint16_t behind,uint16_t ahead,
+                  int32_t * drift)
+{ // 1 if code is the code of a counter from counter-behind to counter+ahead, with
+  // *drift the offset of the nearest such counter from counter; else 0.
+uint32_t best=UINT32_MAX;    // |offset| of the nearest match
+int32_t  found=0;
+
+if (behind>counter) behind=counter;
+for (int32_t i=-(int32_t)behind;i<=ahead;i++) {
+  uint32_t distance=(i<0)?-i:i;
+  uint8_t  take=(OtpCode(otp,counter+i)==code) & (distance<best);
+  uint32_t mask=-(uint32_t)take;
+
+  best =(best&~mask)|(distance&mask);
+  found=(found&~mask)|(i&mask);
+}
+*drift=found;
+return best!=UINT32_MAX;
+}
+// --------------------------------------------------------------------------------
+uint64_t OtpStep(uint64_t unixTime,uint16_t period)
+{ // TOTP counter for a time in seconds since 1970 (T0 0), or 0 for a period of 0
+if (period==0) return 0;
+return unixTime/period;
+}
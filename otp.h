@@ -0,0 +1,29 @@
+#ifndef OTP_H
+#define OTP_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "hmac.h"
+
+// HOTP (RFC 4226) and TOTP (RFC 6238) one time codes on HMAC-SHA1 or HMAC-SHA256,
+// with verification over a window of counters.  See otp.c
+
+#define OTP_MAX_DIGITS  (9)
+
+typedef struct {
+  union {
+    HMAC_SHA1_CTX   sha1;
+    HMAC_SHA256_CTX sha256;
+  };
+  uint32_t modulus;      // 10^digits
+  uint8_t  alg;          // HASH_ID_SHA1 or HASH_ID_SHA256
+} OTP_KEY;
+
+uint8_t  OtpInit(OTP_KEY *,uint8_t alg,char * key,uint16_t keyLength,uint8_t digits);
+uint32_t OtpCode(OTP_KEY *,uint64_t counter);
+void     OtpCodes(OTP_KEY *,uint64_t counter,uint16_t n,uint32_t * codes);
+uint8_t  OtpVerify(OTP_KEY *,uint32_t code,uint64_t counter,uint16_t behind,uint16_t ahead,
+                   int32_t * drift);
+uint64_t OtpStep(uint64_t unixTime,uint16_t period);
+
+#endif
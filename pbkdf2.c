@@ -0,0 +1,185 @@
+/* PBKDF2-HMAC-SHA1 and PBKDF2-HMAC-SHA256
+
+   The HMAC midstates are computed once per password (hmac.c), and every iteration
+   after the first is a fixed length input (the previous U), so each costs exactly
+   two Transforms through HMACxxxShort() rather than four via Init/Update/Final.
+   U is chained through buffer in place, without copying.
+
+   Output blocks are independent, as are passwords, so PBKDF2Batch() derives many
+   keys at once with every (password, output block) pair a separate item on the
+   work stealing pool (HASH_THREADS in config.h; otherwise serially).  Each item
+   sets up its own midstates, two Transforms against thousands of iterations.
+
+   e.g. the WPA2 pre-shared key is
+     PBKDF2SHA1(passphrase,strlen(passphrase),ssid,strlen(ssid),4096,psk,32);
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "pbkdf2.h"
+#include "pool.h"
+#include <string.h> // memcpy
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+typedef struct {
+  PBKDF2_JOB * jobs;
+  uint32_t iterations;
+  uint16_t outputLength;
+  uint16_t blocks;       // Output blocks per job
+  uint8_t  alg;
+} DERIVING;
+
+static void BlockSHA1(HMAC_SHA1_CTX * hmac,char * salt,uint16_t saltLength,uint32_t block,
+                      uint32_t iterations,char * T);
+static void BlockSHA256(HMAC_SHA256_CTX * hmac,char * salt,uint16_t saltLength,uint32_t block,
+                        uint32_t iterations,char * T);
+static void DeriveChunk(void * arg,uint32_t first,uint32_t last);
+static void BlockIndex(char * output,uint32_t i);
+
+// --------------------------------------------------------------------------------
+void PBKDF2SHA1(char * password,uint16_t passwordLength,char * salt,uint16_t saltLength,
+                uint32_t iterations,char * output,uint16_t outputLength)
+{
+HMAC_SHA1_CTX hmac;
+char T[SHA1_RESULT_BYTES];
+
+HMACSHA1Init(&hmac,password,passwordLength);
+
+for (uint32_t block=1;outputLength;block++) {
+  BlockSHA1(&hmac,salt,saltLength,block,iterations,T);
+  uint8_t n=(outputLength<SHA1_RESULT_BYTES)?outputLength:SHA1_RESULT_BYTES;
+  memcpy(output,T,n);
+  output+=n;
+  outputLength-=n;
+}
+memset(&hmac,0,sizeof(hmac));  // Clean sensitive intermediates
+memset(T,0,sizeof(T));
+memset(buffer,0,SHA1_RESULT_BYTES);
+}
+// --------------------------------------------------------------------------------
+void PBKDF2SHA256(char * password,uint16_t passwordLength,char * salt,uint16_t saltLength,
+                  uint32_t iterations,char * output,uint16_t outputLength)
+{
+HMAC_SHA256_CTX hmac;
+char T[SHA256_RESULT_BYTES];
+
+HMACSHA256Init(&hmac,password,passwordLength);
+
+for (uint32_t block=1;outputLength;block++) {
+  BlockSHA256(&hmac,salt,saltLength,block,iterations,T);
+  uint8_t n=(outputLength<SHA256_RESULT_BYTES)?outputLength:SHA256_RESULT_BYTES;
+  memcpy(output,T,n);
+  output+=n;
+  outputLength-=n;
+}
+memset(&hmac,0,sizeof(hmac));  // Clean sensitive intermediates
+memset(T,0,sizeof(T));
+memset(buffer,0,SHA256_RESULT_BYTES);
+}
+// --------------------------------------------------------------------------------
+uint8_t PBKDF2Batch(PBKDF2_JOB * jobs,uint32_t n,uint8_t alg,uint32_t iterations,
+                    uint16_t outputLength,uint8_t threads)
+{ // Derives outputLength chars into each job's output, all with alg (HASH_ID_SHA1 or
+  // HASH_ID_SHA256) and iterations.  Returns 1, or 0 for any other alg or more
+  // than 2^32 - 1 (job, output block) pairs.  threads 0 means PoolThreads().
+uint32_t bounds[POOL_MAX_CHUNKS+1];
+uint8_t  size=(alg==HASH_ID_SHA1)?SHA1_RESULT_BYTES:(alg==HASH_ID_SHA256)?SHA256_RESULT_BYTES:0;
+DERIVING deriving={jobs,iterations,outputLength,0,alg};
+
+if (size==0) return 0;
+deriving.blocks=(outputLength+size-1)/size;
+if (deriving.blocks && n>UINT32_MAX/deriving.blocks) return 0;
+if (threads==0) threads=PoolThreads();
+PoolRun(DeriveChunk,&deriving,bounds,PoolSplit(bounds,n*deriving.blocks,threads),threads);
+return 1;
+}
+// --------------------------------------------------------------------------------
+static void BlockSHA1(HMAC_SHA1_CTX * hmac,char * salt,uint16_t saltLength,uint32_t block,
+                      uint32_t iterations,char * T)
+{ // T = output block number block (from 1)
+SHA1_CTX ctx=hmac->inner;              // U1 = HMAC(salt || INT(block))
+char index[4];
+
+SHA1Update(&ctx,salt,saltLength);
+BlockIndex(index,block);
+SHA1Update(&ctx,index,4);
+HMACSHA1Final(hmac,&ctx);
+memcpy(T,buffer,SHA1_RESULT_BYTES);
+
+for (uint32_t i=1;i<iterations;i++) {  // Un = HMAC(Un-1), Un-1 already in buffer
+  HMACSHA1Short(hmac,buffer,SHA1_RESULT_BYTES);
+  for (uint8_t j=0;j<SHA1_RESULT_BYTES;j++) T[j]^=buffer[j];
+}
+}
+// --------------------------------------------------------------------------------
+static void BlockSHA256(HMAC_SHA256_CTX * hmac,char * salt,uint16_t saltLength,uint32_t block,
+                        uint32_t iterations,char * T)
+{ // T = output block number block (from 1)
+SHA256_CTX ctx=hmac->inner;            // U1 = HMAC(salt || INT(block))
+char index[4];
+
+SHA256Update(&ctx,salt,saltLength);
+BlockIndex(index,block);
+SHA256Update(&ctx,index,4);
+HMACSHA256Final(hmac,&ctx);
+memcpy(T,buffer,SHA256_RESULT_BYTES);
+
+for (uint32_t i=1;i<iterations;i++) {  // Un = HMAC(Un-1), Un-1 already in buffer
+  HMACSHA256Short(hmac,buffer,SHA256_RESULT_BYTES);
+  for (uint8_t j=0;j<SHA256_RESULT_BYTES;j++) T[j]^=buffer[j];
+}
+}
+// --------------------------------------------------------------------------------
+static void DeriveChunk(void * arg,uint32_t first,uint32_t last)
+{ // Items are (job, output block) pairs, job major
+DERIVING * d=(DERIVING *)arg;
+union {
+  HMAC_SHA1_CTX   sha1;
+  HMAC_SHA256_CTX sha256;
+} hmac;
+char T[SHA256_RESULT_BYTES];
+
+for (uint32_t i=first;i<last;i++) {
+  PBKDF2_JOB * job=&d->jobs[i/d->blocks];
+  uint16_t block=i%d->blocks;
+  uint8_t  size,n;
+
+  if (d->alg==HASH_ID_SHA1) {
+    size=SHA1_RESULT_BYTES;
+    HMACSHA1Init(&hmac.sha1,job->password,job->passwordLength);
+    BlockSHA1(&hmac.sha1,job->salt,job->saltLength,block+1,d->iterations,T);
+  } else {
+    size=SHA256_RESULT_BYTES;
+    HMACSHA256Init(&hmac.sha256,job->password,job->passwordLength);
+    BlockSHA256(&hmac.sha256,job->salt,job->saltLength,block+1,d->iterations,T);
+  }
+  n=(d->outputLength-block*size<size)?d->outputLength-block*size:size;
+  memcpy(&job->output[block*size],T,n);
+}
+memset(&hmac,0,sizeof(hmac));  // Clean sensitive intermediates
+memset(T,0,sizeof(T));
+memset(buffer,0,SHA256_RESULT_BYTES);
+}
+// --------------------------------------------------------------------------------
+static void BlockIndex(char * output,uint32_t i)
+{ // Bigendian block number
+output[0]=i>>24;
+output[1]=i>>16;
+output[2]=i>>8;
+output[3]=i;
+}
@@ -0,0 +1,26 @@
+#ifndef PBKDF2_H
+#define PBKDF2_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "hmac.h"
+
+// PBKDF2 (RFC 8018) over HMAC-SHA1 and HMAC-SHA256
+
+// One key of a batch
+typedef struct {
+  char *   password;
+  char *   salt;
+  char *   output;       // outputLength chars
+  uint16_t passwordLength;
+  uint16_t saltLength;
+} PBKDF2_JOB;
+
+void PBKDF2SHA1(char * password,uint16_t passwordLength,char * salt,uint16_t saltLength,
+                uint32_t iterations,char * output,uint16_t outputLength);
+void PBKDF2SHA256(char * password,uint16_t passwordLength,char * salt,uint16_t saltLength,
+                  uint32_t iterations,char * output,uint16_t outputLength);
+uint8_t PBKDF2Batch(PBKDF2_JOB * jobs,uint32_t n,uint8_t alg,uint32_t iterations,
+                    uint16_t outputLength,uint8_t threads);
+
+#endif
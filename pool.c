@@ -0,0 +1,170 @@
+/* Work stealing pool : runs a list of independent chunks of work on several threads
+
+   Each thread starts with a contiguous share of the chunks and takes them from the
+   front of its share.  A thread that runs out steals the back half of another
+   thread's remaining share, so a few slow chunks (e.g. one huge message in a batch
+   of small ones) do not leave the other threads idle.  Chunks never create more
+   work, so once every share is empty all threads can finish.
+
+   Only on hosts, with HASH_THREADS defined in config.h; otherwise PoolRun() simply
+   runs every chunk in the caller.  The calling thread is one of the workers.
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "pool.h"
+
+#ifdef HASH_THREADS
+#include <pthread.h>
+#include <unistd.h> // sysconf
+
+typedef struct {
+  pthread_mutex_t lock;
+  uint32_t  head;         // Next chunk to run
+  uint32_t  tail;         // One beyond the last chunk of this share
+  uint8_t   id;
+  struct POOL_S * pool;
+} POOL_WORKER;
+
+typedef struct POOL_S {
+  POOL_TASK   task;
+  void      * arg;
+  uint32_t  * bounds;
+  uint8_t     threads;
+  POOL_WORKER worker[POOL_MAX_THREADS];
+} POOL;
+
+static void * Worker(void * arg);
+static uint8_t Take(POOL_WORKER * self,uint32_t * chunk);
+static uint8_t Steal(POOL_WORKER * self);
+#endif
+
+// --------------------------------------------------------------------------------
+uint8_t PoolThreads(void)
+{ // Threads worth using : the online processors, within POOL_MAX_THREADS
+#ifdef HASH_THREADS
+long n=sysconf(_SC_NPROCESSORS_ONLN);
+
+if (n<1) return 1;
+return (n>POOL_MAX_THREADS)?POOL_MAX_THREADS:n;
+#else
+return 1;
+#endif
+}
+// --------------------------------------------------------------------------------
+uint32_t PoolSplit(uint32_t * bounds,uint32_t items,uint8_t threads)
+{ // Cuts items into near equal chunks for PoolRun() on threads threads :
+  // POOL_CHUNKS_PER_THREAD each, but no more than POOL_MAX_CHUNKS (so bounds, of
+  // POOL_MAX_CHUNKS+1, is never overrun) or items.  Returns the number of chunks.
+uint32_t chunks;
+
+if (threads>POOL_MAX_THREADS) threads=POOL_MAX_THREADS;
+if (threads==0) threads=1;
+chunks=(uint32_t)threads*POOL_CHUNKS_PER_THREAD;
+if (chunks>items) chunks=items;
+bounds[0]=0;
+for (uint32_t c=1;c<=chunks;c++) bounds[c]=(uint64_t)items*c/chunks;
+return chunks;
+}
+// --------------------------------------------------------------------------------
+void PoolRun(POOL_TASK task,void * arg,uint32_t * bounds,uint32_t chunks,uint8_t threads)
+{ // Runs task on every chunk, on up to threads threads, returning when all are done
+#ifdef HASH_THREADS
+POOL pool;
+pthread_t thread[POOL_MAX_THREADS];
+
+if (threads>POOL_MAX_THREADS) threads=POOL_MAX_THREADS;
+if (threads>chunks) threads=chunks;
+if (threads>1) {
+  pool.task=task;
+  pool.arg=arg;
+  pool.bounds=bounds;
+  pool.threads=threads;
+  for (uint8_t i=0;i<threads;i++) {   // Contiguous, near equal shares
+    pthread_mutex_init(&pool.worker[i].lock,NULL);
+    pool.worker[i].head=(uint64_t)chunks*i/threads;
+    pool.worker[i].tail=(uint64_t)chunks*(i+1)/threads;
+    pool.worker[i].id=i;
+    pool.worker[i].pool=&pool;
+  }
+  for (uint8_t i=1;i<threads;i++)
+    if (pthread_create(&thread[i],NULL,Worker,&pool.worker[i])) 
+      pool.worker[i].pool=NULL;     // Share is stolen by the others instead
+  Worker(&pool.worker[0]);
+  for (uint8_t i=1;i<threads;i++) 
+    if (pool.worker[i].pool) pthread_join(thread[i],NULL);
+  for (uint8_t i=0;i<threads;i++) pthread_mutex_destroy(&pool.worker[i].lock);
+  return;
+}
+#else
+(void)threads;
+#endif
+for (uint32_t c=0;c<chunks;c++) task(arg,bounds[c],bounds[c+1]);
+}
+#ifdef HASH_THREADS
+// --------------------------------------------------------------------------------
+static void * Worker(void * arg)
+{ // Runs own share from the front, then steals until nothing is left anywhere
+POOL_WORKER * self=(POOL_WORKER *)arg;
+POOL * pool=self->pool;
+uint32_t chunk;
+
+do {
+  while (Take(self,&chunk)) 
+    pool->task(pool->arg,pool->bounds[chunk],pool->bounds[chunk+1]);
+} while (Steal(self));
+return NULL;
+}
+// --------------------------------------------------------------------------------
+static uint8_t Take(POOL_WORKER * self,uint32_t * chunk)
+{ // Next chunk of own share, if any
+uint8_t ok=0;
+
+pthread_mutex_lock(&self->lock);
+if (self->head<self->tail) {
+  *chunk=self->head++;
+  ok=1;
+}
+pthread_mutex_unlock(&self->lock);
+return ok;
+}
+// --------------------------------------------------------------------------------
+static uint8_t Steal(POOL_WORKER * self)
+{ // Moves the back half of the first non-empty share found into (empty) own share
+POOL * pool=self->pool;
+
+for (uint8_t k=1;k<pool->threads;k++) {
+  POOL_WORKER * victim=&pool->worker[(self->id+k)%pool->threads];
+  uint32_t head,tail;
+
+  pthread_mutex_lock(&victim->lock);
+  tail=victim->tail;
+  head=tail-(tail-victim->head+1)/2;
+  victim->tail=head;
+  pthread_mutex_unlock(&victim->lock);
+
+  if (head<tail) {
+    pthread_mutex_lock(&self->lock);
+    self->head=head;
+    self->tail=tail;
+    pthread_mutex_unlock(&self->lock);
+    return 1;
+  }
+}
+return 0;
+}
+#endif
@@ -0,0 +1,24 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+
+// Work stealing pool for host batch jobs (HASH_THREADS in config.h), otherwise runs
+// everything in the caller.  Work is a list of chunks, chunk c being items
+// bounds[c] .. bounds[c+1]-1, sized by the caller so that chunks cost about the same.
+
+#ifdef HASH_THREADS
+#define POOL_MAX_THREADS       (64)
+#else
+#define POOL_MAX_THREADS        (1)
+#endif
+#define POOL_CHUNKS_PER_THREAD (16)  // Suggested, leaves enough chunks to balance by stealing
+#define POOL_MAX_CHUNKS        (POOL_MAX_THREADS*POOL_CHUNKS_PER_THREAD)
+
+typedef void (*POOL_TASK)(void * arg,uint32_t first,uint32_t last);  // Items first..last-1
+
+uint8_t  PoolThreads(void);
+uint32_t PoolSplit(uint32_t * bounds,uint32_t items,uint8_t threads);
+void     PoolRun(POOL_TASK task,void * arg,uint32_t * bounds,uint32_t chunks,uint8_t threads);
+
+#endif
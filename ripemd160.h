@@ -1,23 +1,57 @@
-#include <stdint.h>
-#include "hash.h"
-
-// RIPEMD160 data. 
-
-#define RIPEMD160_BUF_OFFSET     (4)
-#define RIPEMD160_INPUT_BYTES   (64)  // Input bytes at a time
-#define RIPEMD160_SIZE_BYTES     (8)  // Bytes for internal input representation of size 
-#define RIPEMD160_RESULT_BYTES  (20)  // Hash result size in bytes
-#define RIPEMD160_LSW            (0)  // Least significant word for size
-#define RIPEMD160_MSW            (1)
-
-typedef struct {
-  JOINED H[RIPEMD160_RESULT_BYTES/4];
-  uint32_t count[RIPEMD160_SIZE_BYTES/4];
-} RIPEMD160_CTX;
-
-#define RIPEMD160_MATCH(X,Y) (memcmp((X),(Y),RIPEMD160_RESULT_BYTES))
-
-void RIPEMD160Init(RIPEMD160_CTX *);
-void RIPEMD160Update(RIPEMD160_CTX *,char * data,uint16_t length);
-void RIPEMD160AddExpandedHash(RIPEMD160_CTX *,uint8_t * data);
-void RIPEMD160Final(RIPEMD160_CTX *);
\ No newline at end of file
+#ifndef RIPEMD160_H
+#define RIPEMD160_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "checkpoint.h"
+#include "arena.h"
+
+// RIPEMD160 data. 
+
+#define RIPEMD160_BUF_OFFSET     (4)
+#define RIPEMD160_INPUT_BYTES   (64)  // Input bytes at a time
+#define RIPEMD160_SIZE_BYTES     (8)  // Bytes for internal input representation of size 
+#define RIPEMD160_RESULT_BYTES  (20)  // Hash result size in bytes
+#define RIPEMD160_LSW            (0)  // Least significant word for size
+#define RIPEMD160_MSW            (1)
+
+typedef struct {
+  JOINED H[RIPEMD160_RESULT_BYTES/4];
+  uint32_t count[RIPEMD160_SIZE_BYTES/4];
+} RIPEMD160_CTX;
+
+// Bounded latency (sliced) hashing : a Transform in progress, with its working registers
+typedef struct {
+  RIPEMD160_CTX ctx;
+  uint32_t ABCDE[5];     // Working registers, left line, of the block in progress
+  uint32_t PRIME[5];     // ... right line
+  uint8_t  step;         // Next step of the block in progress, or RIPEMD160_SLICE_IDLE
+  uint8_t  final;        // Progress through padding in RIPEMD160SliceFinal()
+} RIPEMD160_SLICE_CTX;
+
+#define RIPEMD160_SLICE_IDLE  (0xFF)
+
+#define RIPEMD160_MATCH(X,Y) (memcmp((X),(Y),RIPEMD160_RESULT_BYTES))
+
+// Serialise/reinstate an in-progress hash, see checkpoint.c.  O needs HASH_CHECKPOINT_MAX chars
+#define RIPEMD160Save(C,O)    (HashCheckpointSave((O),HASH_ID_RIPEMD160,(C)->H,RIPEMD160_RESULT_BYTES,(C)->count,RIPEMD160_LSW))
+#define RIPEMD160Restore(C,I) (HashCheckpointRestore((I),HASH_ID_RIPEMD160,(C)->H,RIPEMD160_RESULT_BYTES,(C)->count,RIPEMD160_LSW))
+
+// Share buffer between many concurrent hashes, see arena.c.  Lease before each Update/Final
+#define RIPEMD160Lease(C,A,S) (ArenaLease((A),(S),(C)->count,RIPEMD160_LSW))
+
+void RIPEMD160Init(RIPEMD160_CTX *);
+void RIPEMD160Update(RIPEMD160_CTX *,char * data,uint16_t length);
+void RIPEMD160UpdateV(RIPEMD160_CTX *,HASH_IOVEC * iov,uint8_t n);
+void RIPEMD160UpdateRing(RIPEMD160_CTX *,char * ring,uint16_t size,uint16_t start,uint16_t length);
+void RIPEMD160AddExpandedHash(RIPEMD160_CTX *,uint8_t * data);
+void RIPEMD160Final(RIPEMD160_CTX *);
+#ifdef HASH_LANES
+void RIPEMD160TransformLanes(uint32_t * state,char ** block,uint8_t lanes);
+#endif
+
+void     RIPEMD160SliceInit(RIPEMD160_SLICE_CTX *);
+uint16_t RIPEMD160SliceUpdate(RIPEMD160_SLICE_CTX *,char * data,uint16_t length,uint8_t rounds);
+uint8_t  RIPEMD160SliceFinal(RIPEMD160_SLICE_CTX *,uint8_t rounds);
+
+#endif
\ No newline at end of file
@@ -1,22 +1,40 @@
-#include <stdint.h>
-#include "hash.h"
-
-// SHA1 data. 
-
-#define SHA1_BUF_OFFSET     (4)
-#define SHA1_INPUT_BYTES   (64)  // Input bytes at a time
-#define SHA1_SIZE_BYTES     (8)  // Bytes for internal input representation of size
-#define SHA1_RESULT_BYTES  (20)  // Hash result size in bytes
-#define SHA1_LSW            (1)  // Least significant word for size
-#define SHA1_MSW            (0)
-
-typedef struct {
-  JOINED H[SHA1_RESULT_BYTES/4];
-  uint32_t count[SHA1_SIZE_BYTES/4];
-} SHA1_CTX;
-
-#define SHA1_MATCH(X,Y) (memcmp((X),(Y),SHA1_RESULT_BYTES))
-
-void SHA1Init(SHA1_CTX *);
-void SHA1Update(SHA1_CTX *,char * data,uint16_t length);
-void SHA1Final(SHA1_CTX *);
\ No newline at end of file
+#ifndef SHA1_H
+#define SHA1_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "checkpoint.h"
+#include "arena.h"
+
+// SHA1 data. 
+
+#define SHA1_BUF_OFFSET     (4)
+#define SHA1_INPUT_BYTES   (64)  // Input bytes at a time
+#define SHA1_SIZE_BYTES     (8)  // Bytes for internal input representation of size
+#define SHA1_RESULT_BYTES  (20)  // Hash result size in bytes
+#define SHA1_LSW            (1)  // Least significant word for size
+#define SHA1_MSW            (0)
+
+typedef struct {
+  JOINED H[SHA1_RESULT_BYTES/4];
+  uint32_t count[SHA1_SIZE_BYTES/4];
+} SHA1_CTX;
+
+#define SHA1_MATCH(X,Y) (memcmp((X),(Y),SHA1_RESULT_BYTES))
+
+// Serialise/reinstate an in-progress hash, see checkpoint.c.  O needs HASH_CHECKPOINT_MAX chars
+#define SHA1Save(C,O)    (HashCheckpointSave((O),HASH_ID_SHA1,(C)->H,SHA1_RESULT_BYTES,(C)->count,SHA1_LSW))
+#define SHA1Restore(C,I) (HashCheckpointRestore((I),HASH_ID_SHA1,(C)->H,SHA1_RESULT_BYTES,(C)->count,SHA1_LSW))
+
+// Share buffer between many concurrent hashes, see arena.c.  Lease before each Update/Final
+#define SHA1Lease(C,A,S) (ArenaLease((A),(S),(C)->count,SHA1_LSW))
+
+void SHA1Init(SHA1_CTX *);
+void SHA1Update(SHA1_CTX *,char * data,uint16_t length);
+void SHA1UpdateV(SHA1_CTX *,HASH_IOVEC * iov,uint8_t n);
+void SHA1UpdateRing(SHA1_CTX *,char * ring,uint16_t size,uint16_t start,uint16_t length);
+void SHA1Final(SHA1_CTX *);
+void SHA1FinalBlock(SHA1_CTX *,char * data,uint8_t length);
+void SHA1Iterate(JOINED * digest,uint32_t n);
+
+#endif
\ No newline at end of file
@@ -1,23 +1,55 @@
-#include <stdint.h>
-#include "hash.h"
-
-// SHA256 data. 
-
-#define SHA256_BUF_OFFSET     (4)
-#define SHA256_INPUT_BYTES   (64)  // Input bytes at a time
-#define SHA256_SIZE_BYTES     (8)  // Bytes for internal input size representation
-#define SHA256_RESULT_BYTES  (32)  // Hash result size in bytes
-#define SHA256_LSW            (1)  // Least significant word for size
-#define SHA256_MSW            (0)
-
-typedef struct {
-  JOINED H[SHA256_RESULT_BYTES/4];
-  uint32_t count[SHA256_SIZE_BYTES/4];
-} SHA256_CTX;
-
-#define SHA256_MATCH(X,Y) (memcmp((X),(Y),SHA256_RESULT_BYTES))
-
-void SHA256Init(SHA256_CTX *);
-void SHA256Update(SHA256_CTX *,char * data,uint16_t length);
-void SHA256AddExpandedHash(SHA256_CTX *,uint8_t * data);
-void SHA256Final(SHA256_CTX *);
\ No newline at end of file
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stdint.h>
+#include "hash.h"
+#include "checkpoint.h"
+#include "arena.h"
+
+// SHA256 data. 
+
+#define SHA256_BUF_OFFSET     (4)
+#define SHA256_INPUT_BYTES   (64)  // Input bytes at a time
+#define SHA256_SIZE_BYTES     (8)  // Bytes for internal input size representation
+#define SHA256_RESULT_BYTES  (32)  // Hash result size in bytes
+#define SHA256_LSW            (1)  // Least significant word for size
+#define SHA256_MSW            (0)
+
+typedef struct {
+  JOINED H[SHA256_RESULT_BYTES/4];
+  uint32_t count[SHA256_SIZE_BYTES/4];
+} SHA256_CTX;
+
+// Bounded latency (sliced) hashing : a Transform in progress, with its working registers
+typedef struct {
+  SHA256_CTX ctx;
+  uint32_t ABCDEFGH[8];  // Working registers of the block in progress
+  uint8_t  step;         // Next round of the block in progress, or SHA256_SLICE_IDLE
+  uint8_t  final;        // Progress through padding in SHA256SliceFinal()
+} SHA256_SLICE_CTX;
+
+#define SHA256_SLICE_IDLE  (0xFF)
+
+#define SHA256_MATCH(X,Y) (memcmp((X),(Y),SHA256_RESULT_BYTES))
+
+// Serialise/reinstate an in-progress hash, see checkpoint.c.  O needs HASH_CHECKPOINT_MAX chars
+#define SHA256Save(C,O)    (HashCheckpointSave((O),HASH_ID_SHA256,(C)->H,SHA256_RESULT_BYTES,(C)->count,SHA256_LSW))
+#define SHA256Restore(C,I) (HashCheckpointRestore((I),HASH_ID_SHA256,(C)->H,SHA256_RESULT_BYTES,(C)->count,SHA256_LSW))
+
+// Share buffer between many concurrent hashes, see arena.c.  Lease before each Update/Final
+#define SHA256Lease(C,A,S) (ArenaLease((A),(S),(C)->count,SHA256_LSW))
+
+void SHA256Init(SHA256_CTX *);
+void SHA256Update(SHA256_CTX *,char * data,uint16_t length);
+void SHA256UpdateV(SHA256_CTX *,HASH_IOVEC * iov,uint8_t n);
+void SHA256UpdateRing(SHA256_CTX *,char * ring,uint16_t size,uint16_t start,uint16_t length);
+void SHA256AddExpandedHash(SHA256_CTX *,uint8_t * data);
+void SHA256Final(SHA256_CTX *);
+void SHA256FinalBlock(SHA256_CTX *,char * data,uint8_t length);
+void SHA256Iterate(JOINED * digest,uint32_t n);
+
+void     SHA256SliceInit(SHA256_SLICE_CTX *);
+uint16_t SHA256SliceUpdate(SHA256_SLICE_CTX *,char * data,uint16_t length,uint8_t rounds);
+uint8_t  SHA256SliceFinal(SHA256_SLICE_CTX *,uint8_t rounds);
+
+#endif
\ No newline at end of file
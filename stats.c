@@ -0,0 +1,93 @@
+/* Hot path instrumentation counters
+
+   When HASH_STATS is defined each algorithm counts, per algorithm, the bytes it
+   absorbs, whole versus completed-from-leftovers blocks, transforms run, bytes
+   copied into buffer and cycles spent in each phase.  Cycles come from the time
+   stamp counter on x86 hosts and read as zero elsewhere.  Without HASH_STATS this
+   file compiles to nothing and the counting macros vanish from the hot paths.
+
+   HashStatsSnapshot() copies the counters; HashStatsJSON() renders them for a
+   metrics agent, e.g.
+
+   {"md5":{"bytes":1500,"updates":20,"fullBlocks":3,"partialBlocks":20,
+    "transforms":24,"copied":1500,"cycles":{"update":..,"transform":..,
+    "final":..,"expand":..}},"sha1":{...},"sha256":{...},"ripemd160":{...},
+    "blake2s":{...}}
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "stats.h"
+
+#ifdef HASH_STATS
+
+#include <stdio.h>  // snprintf
+#include <string.h> // memcpy
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+HASH_COUNTERS hashStats[STATS_ALGORITHMS];
+
+static const char * const name[STATS_ALGORITHMS]={"md5","sha1","sha256","ripemd160","blake2s"};
+
+// --------------------------------------------------------------------------------
+uint64_t StatsCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+return __rdtsc();
+#else
+return 0;
+#endif
+}
+// --------------------------------------------------------------------------------
+void HashStatsSnapshot(HASH_COUNTERS * copy)
+{ // copy must hold STATS_ALGORITHMS entries
+memcpy(copy,hashStats,sizeof(hashStats));
+}
+// --------------------------------------------------------------------------------
+void HashStatsReset(void)
+{
+memset(hashStats,0,sizeof(hashStats));
+}
+// --------------------------------------------------------------------------------
+uint16_t HashStatsJSON(char * output,uint16_t size)
+{ // Writes the counters as one JSON object.  Returns length written (excluding the
+  // terminating 0), or 0 if size was too small.
+HASH_COUNTERS s[STATS_ALGORITHMS];
+int len=0;
+
+HashStatsSnapshot(s);
+for (uint8_t i=0;i<STATS_ALGORITHMS && len>=0 && len<size;i++) {
+  int n=snprintf(&output[len],size-len,
+    "%s\"%s\":{\"bytes\":%llu,\"updates\":%lu,\"fullBlocks\":%lu,\"partialBlocks\":%lu,"
+    "\"transforms\":%lu,\"copied\":%llu,\"cycles\":{\"update\":%llu,\"transform\":%llu,"
+    "\"final\":%llu,\"expand\":%llu}}%s",
+    i?",":"{",name[i],(unsigned long long)s[i].bytes,(unsigned long)s[i].updates,
+    (unsigned long)s[i].fullBlocks,(unsigned long)s[i].partialBlocks,
+    (unsigned long)s[i].transforms,(unsigned long long)s[i].copied,
+    (unsigned long long)s[i].cycles[STATS_PHASE_UPDATE],
+    (unsigned long long)s[i].cycles[STATS_PHASE_TRANSFORM],
+    (unsigned long long)s[i].cycles[STATS_PHASE_FINAL],
+    (unsigned long long)s[i].cycles[STATS_PHASE_EXPAND],
+    (i==STATS_ALGORITHMS-1)?"}":"");
+  len=(n<0)?-1:len+n;
+}
+return (len<0 || len>=size)?0:(uint16_t)len;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include "config.h"
+#include "hash.h"
+
+// Optional hot path instrumentation.  Compiled out unless HASH_STATS is defined (config.h)
+
+#define STATS_PHASE_UPDATE     (0)  // Phases timed.  Each includes the Transforms it calls
+#define STATS_PHASE_TRANSFORM  (1)
+#define STATS_PHASE_FINAL      (2)
+#define STATS_PHASE_EXPAND     (3)  // *AddExpandedHash()
+#define STATS_PHASES           (4)
+
+#define STATS_ALGORITHMS       (5)  // Indexed by HASH_ID_xxx-1
+
+typedef struct {
+  uint64_t bytes;          // Absorbed by *Update()
+  uint32_t updates;        // Calls to *Update()
+  uint32_t fullBlocks;     // Blocks taken whole from the caller's input
+  uint32_t partialBlocks;  // Blocks assembled in buffer (leftovers of a previous call or fragments)
+  uint32_t transforms;
+  uint64_t copied;         // Bytes memcpy'd into buffer
+  uint64_t cycles[STATS_PHASES];
+} HASH_COUNTERS;
+
+#ifdef HASH_STATS
+
+extern HASH_COUNTERS hashStats[STATS_ALGORITHMS];
+
+uint64_t StatsCycles(void);
+void     HashStatsSnapshot(HASH_COUNTERS * copy);
+void     HashStatsReset(void);
+uint16_t HashStatsJSON(char * output,uint16_t size);
+
+// STATS_ID must be defined, as the HASH_ID_xxx of the file using these
+#define STATS_ADD(FIELD,N)     (hashStats[STATS_ID-1].FIELD+=(N))
+#define STATS_START(T)         uint64_t T=StatsCycles()
+#define STATS_STOP(PHASE,T)    (hashStats[STATS_ID-1].cycles[PHASE]+=StatsCycles()-(T))
+
+#else
+
+#define STATS_ADD(FIELD,N)     ((void)0)
+#define STATS_START(T)
+#define STATS_STOP(PHASE,T)    ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,133 @@
+/* Checks that a hash saved with XXXSave() and resumed with XXXRestore() part way
+   through a message gives the one-shot digest
+
+   For each of MD5, SHA1, SHA256 and RIPEMD160, a 1000 char message (high bit bytes
+   included) is split at every point from 0 to 300 and at several later ones.  The
+   first part is hashed in uneven pieces and saved; the context and buffer are then
+   wiped before the checkpoint is restored into a new context and the rest hashed.
+   A log growing by three appends, resumed after each, and checkpoints from the
+   wrong algorithm or version are checked too.  Exits 0 if everything passes.
+
+     gcc -std=gnu99 -O2 -funsigned-char -I.. checkpoint_test.c ../checkpoint.c ../md5.c ../sha1.c ../sha256.c ../ripemd160.c
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "checkpoint.h"
+#include "md5.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "ripemd160.h"
+
+#define LENGTH  (1000)
+
+HASH_TLS char buffer[MSG_LENGTH];
+char hex[]="0123456789ABCDEF";
+
+static char message[LENGTH];
+static uint32_t failures;
+
+// Hashes data[0..length-1] in pieces of 1, 2, .. 70 chars
+#define PIECES(ALG,ctx,data,length) { \
+  uint32_t done=0; \
+  for (uint16_t piece=1;done<(length);piece=piece%70+1) { \
+    uint16_t n=((length)-done<piece)?(length)-done:piece; \
+    ALG##Update(ctx,&(data)[done],n); \
+    done+=n; \
+  } \
+}
+
+// One algorithm : split resumes, a growing log, and refused checkpoints
+#define CHECK(ALG,CTX,BYTES) { \
+  CTX ctx; \
+  char expect[BYTES],store[HASH_CHECKPOINT_MAX]; \
+  uint32_t words[8+2]; \
+  uint16_t splits[310]; \
+  uint16_t n=0; \
+  \
+  ALG##Init(&ctx); \
+  ALG##Update(&ctx,message,LENGTH); \
+  ALG##Final(&ctx); \
+  memcpy(expect,buffer,BYTES); \
+  for (uint16_t s=0;s<=300;s++) splits[n++]=s; \
+  splits[n++]=511; splits[n++]=512; splits[n++]=513; splits[n++]=LENGTH-1; splits[n++]=LENGTH; \
+  \
+  for (uint16_t k=0;k<n;k++) { \
+    uint16_t s=splits[k]; \
+    ALG##Init(&ctx); \
+    PIECES(ALG,&ctx,message,s); \
+    ALG##Save(&ctx,store); \
+    memset(&ctx,0xA5,sizeof(ctx));    /* Nothing may survive but the checkpoint */ \
+    memset(buffer,0x5A,MSG_LENGTH); \
+    if (!ALG##Restore(&ctx,store) || HashCheckpointBytes(store)!=s) { \
+      printf(#ALG " : split at %u not restored\n",s); \
+      failures++; \
+      continue; \
+    } \
+    PIECES(ALG,&ctx,&message[s],LENGTH-s); \
+    ALG##Final(&ctx); \
+    if (memcmp(buffer,expect,BYTES)) { \
+      printf(#ALG " : split at %u gives the wrong digest\n",s); \
+      failures++; \
+    } \
+  } \
+  \
+  ALG##Init(&ctx);                      /* Log growing to 100, 333, then LENGTH chars */ \
+  ALG##Update(&ctx,message,100); \
+  ALG##Save(&ctx,store); \
+  ALG##Final(&ctx); \
+  ALG##Restore(&ctx,store); \
+  ALG##Update(&ctx,&message[HashCheckpointBytes(store)],333-100); \
+  ALG##Save(&ctx,store); \
+  ALG##Final(&ctx); \
+  ALG##Restore(&ctx,store); \
+  ALG##Update(&ctx,&message[HashCheckpointBytes(store)],LENGTH-333); \
+  ALG##Final(&ctx); \
+  if (memcmp(buffer,expect,BYTES)) { \
+    printf(#ALG " : growing log gives the wrong digest\n"); \
+    failures++; \
+  } \
+  \
+  ALG##Init(&ctx); \
+  ALG##Update(&ctx,message,77); \
+  ALG##Save(&ctx,store); \
+  if (HashCheckpointRestore(store,store[1]%HASH_ID_BLAKE2S+1,(JOINED *)words,BYTES,&words[8],0)) { \
+    printf(#ALG " : checkpoint accepted as another algorithm\n"); \
+    failures++; \
+  } \
+  store[0]++; \
+  if (ALG##Restore(&ctx,store)) { \
+    printf(#ALG " : checkpoint of another version accepted\n"); \
+    failures++; \
+  } \
+}
+
+// --------------------------------------------------------------------------------
+int main(void)
+{
+for (uint16_t i=0;i<LENGTH;i++) message[i]=i*151+(i>>3);
+
+CHECK(MD5,MD5_CTX,MD5_RESULT_BYTES);
+CHECK(SHA1,SHA1_CTX,SHA1_RESULT_BYTES);
+CHECK(SHA256,SHA256_CTX,SHA256_RESULT_BYTES);
+CHECK(RIPEMD160,RIPEMD160_CTX,RIPEMD160_RESULT_BYTES);
+
+printf("%s (%lu failures)\n",failures?"FAILED":"Passed",(unsigned long)failures);
+return failures!=0;
+}
@@ -0,0 +1,163 @@
+/* Name based UUIDs (RFC 4122 versions 3 and 5)
+
+   A version 3 UUID is MD5 (version 5 : SHA1, truncated) of a 16 byte namespace UUID
+   followed by the name, with the version and variant bits then set.  The namespace
+   and the version are parsed once into a UUID_NAMESPACE.  A name of up to
+   UUID_SHORT_NAME characters fits, with the namespace, in one padded block, which is
+   assembled directly in buffer and finished by XXXFinalBlock() : one Transform and
+   no Update.  Longer names go through Init/Update/Final.  (The namespace is shorter
+   than a block, so there is no midstate worth keeping.)
+
+   UuidText() gives the canonical lowercase form, converting all 16 bytes to hex at
+   once on SSE2 hosts.  UuidBatch() mints a UUID, binary or text, per name of an
+   array.
+
+     UUID_NAMESPACE ns;
+     UuidNamespace(&ns,UUID_NAMESPACE_DNS,5);
+     UuidName(&ns,"www.example.com",15,uuid);  // 2ed6657d-e927-568b-95e1-2665a8aea6a2
+
+   Copyright (C) 2026  agent
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config.h"
+
+#include "uuid.h"
+#include "md5.h"
+#include "sha1.h"
+#include <string.h> // memcpy
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+extern HASH_TLS char buffer[MSG_LENGTH];  // MSG_LENGTH must be >=68 and 1st 68 chars will be destroyed
+
+#define UUID_BUF_OFFSET  (4)  // Same as MD5_BUF_OFFSET and SHA1_BUF_OFFSET
+
+#ifndef __SSE2__
+static const char HEX[16] ROM={'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'};
+#endif
+static const uint8_t DASH[4]={8,13,18,23};  // Positions in the text form
+
+static int8_t Nibble(char c);
+
+// --------------------------------------------------------------------------------
+uint8_t UuidNamespace(UUID_NAMESPACE * ns,char * text,uint8_t version)
+{ // Namespace from its canonical text, for version 3 or 5 UUIDs.  Returns 1, or 0 if
+  // text or version is not valid.
+if (version!=3 && version!=5) return 0;
+ns->version=version;
+return UuidParse(text,ns->id);
+}
+// --------------------------------------------------------------------------------
+void UuidName(UUID_NAMESPACE * ns,char * name,uint16_t length,char * output)
+{ // The UUID_BYTES binary UUID of name in ns.  output may be buffer.
+MD5_CTX  md5;
+SHA1_CTX sha1;
+
+if (ns->version==3) MD5Init(&md5);
+else SHA1Init(&sha1);
+
+if (length<=UUID_SHORT_NAME) {
+  memcpy(&buffer[UUID_BUF_OFFSET],ns->id,UUID_BYTES);
+  memcpy(&buffer[UUID_BUF_OFFSET+UUID_BYTES],name,length);
+  if (ns->version==3) MD5FinalBlock(&md5,&buffer[UUID_BUF_OFFSET],UUID_BYTES+length);
+  else SHA1FinalBlock(&sha1,&buffer[UUID_BUF_OFFSET],UUID_BYTES+length);
+}
+else if (ns->version==3) {
+  MD5Update(&md5,ns->id,UUID_BYTES);
+  MD5Update(&md5,name,length);
+  MD5Final(&md5);
+}
+else {
+  SHA1Update(&sha1,ns->id,UUID_BYTES);
+  SHA1Update(&sha1,name,length);
+  SHA1Final(&sha1);
+}
+buffer[6]=(buffer[6]&0x0F)|(ns->version<<4);  // Version
+buffer[8]=(buffer[8]&0x3F)|0x80;              // Variant 10xx
+memmove(output,buffer,UUID_BYTES);
+}
+// --------------------------------------------------------------------------------
+void UuidText(char * uuid,char * output)
+{ // Canonical text form of a binary UUID, UUID_TEXT_BYTES chars, no terminating 0
+char hex[2*UUID_BYTES];
+
+#ifdef __SSE2__
+__m128i x =_mm_loadu_si128((__m128i *)uuid);
+__m128i f =_mm_set1_epi8(0x0F);
+__m128i hi=_mm_and_si128(_mm_srli_epi16(x,4),f);
+__m128i lo=_mm_and_si128(x,f);
+__m128i a =_mm_unpacklo_epi8(hi,lo);   // Nibbles of bytes 0-7, in text order
+__m128i b =_mm_unpackhi_epi8(hi,lo);
+__m128i nine=_mm_set1_epi8(9);
+__m128i zero=_mm_set1_epi8('0');
+__m128i gap =_mm_set1_epi8('a'-'0'-10);
+
+a=_mm_add_epi8(_mm_add_epi8(a,zero),_mm_and_si128(_mm_cmpgt_epi8(a,nine),gap));
+b=_mm_add_epi8(_mm_add_epi8(b,zero),_mm_and_si128(_mm_cmpgt_epi8(b,nine),gap));
+_mm_storeu_si128((__m128i *)hex,a);
+_mm_storeu_si128((__m128i *)&hex[16],b);
+#else
+for (uint8_t i=0;i<UUID_BYTES;i++) {
+  hex[2*i]  =ROM_BYTE(HEX[(uint8_t)uuid[i]>>4]);
+  hex[2*i+1]=ROM_BYTE(HEX[uuid[i]&0x0F]);
+}
+#endif
+memcpy(output,hex,8);
+output[8]='-';
+memcpy(&output[9],&hex[8],4);
+output[13]='-';
+memcpy(&output[14],&hex[12],4);
+output[18]='-';
+memcpy(&output[19],&hex[16],4);
+output[23]='-';
+memcpy(&output[24],&hex[20],12);
+}
+// --------------------------------------------------------------------------------
+uint8_t UuidParse(char * text,char * output)
+{ // Binary UUID from canonical text (either case).  Returns 1, or 0 if not valid.
+uint8_t j=0;
+
+for (uint8_t i=0;i<UUID_TEXT_BYTES;) {
+  if (j<4 && i==DASH[j]) {
+    if (text[i++]!='-') return 0;
+    j++;
+    continue;
+  }
+  int8_t h=Nibble(text[i++]);
+  int8_t l=Nibble(text[i++]);
+  if (h<0 || l<0) return 0;
+  *output++=(h<<4)|l;
+}
+return 1;
+}
+// --------------------------------------------------------------------------------
+void UuidBatch(UUID_NAMESPACE * ns,HASH_IOVEC * names,uint32_t n,char * output,uint8_t text)
+{ // The UUIDs of n names, consecutively in output : UUID_BYTES each, or if text is
+  // set UUID_TEXT_BYTES
+for (uint32_t i=0;i<n;i++) {
+  UuidName(ns,names[i].base,names[i].len,buffer);
+  if (text) UuidText(buffer,&output[i*UUID_TEXT_BYTES]);
+  else memcpy(&output[i*UUID_BYTES],buffer,UUID_BYTES);
+}
+}
+// --------------------------------------------------------------------------------
+static int8_t Nibble(char c)
+{
+if (c>='0' && c<='9') return c-'0';
+if (c>='a' && c<='f') return c-'a'+10;
+if (c>='A' && c<='F') return c-'A'+10;
+return -1;
+}
@@ -0,0 +1,30 @@
+#ifndef UUID_H
+#define UUID_H
+
+#include <stdint.h>
+#include "hash.h"
+
+// RFC 4122 name based UUIDs : version 3 (MD5) and 5 (SHA1).  See uuid.c
+
+#define UUID_BYTES         (16)
+#define UUID_TEXT_BYTES    (36)  // Canonical 8-4-4-4-12 form, no terminating 0
+#define UUID_SHORT_NAME    (39)  // Longest name done in a single Transform
+
+typedef struct {
+  char    id[UUID_BYTES];
+  uint8_t version;       // 3 or 5
+} UUID_NAMESPACE;
+
+// RFC 4122 Appendix C namespaces, canonical text
+#define UUID_NAMESPACE_DNS   "6ba7b810-9dad-11d1-80b4-00c04fd430c8"
+#define UUID_NAMESPACE_URL   "6ba7b811-9dad-11d1-80b4-00c04fd430c8"
+#define UUID_NAMESPACE_OID   "6ba7b812-9dad-11d1-80b4-00c04fd430c8"
+#define UUID_NAMESPACE_X500  "6ba7b814-9dad-11d1-80b4-00c04fd430c8"
+
+uint8_t UuidNamespace(UUID_NAMESPACE *,char * text,uint8_t version);
+void    UuidName(UUID_NAMESPACE *,char * name,uint16_t length,char * output);
+void    UuidText(char * uuid,char * output);
+uint8_t UuidParse(char * text,char * output);
+void    UuidBatch(UUID_NAMESPACE *,HASH_IOVEC * names,uint32_t n,char * output,uint8_t text);
+
+#endif